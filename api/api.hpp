@@ -4,6 +4,7 @@
 #include <winsock2.h>
 #include <windows.h>
 #include <ws2tcpip.h>
+#include <io.h>
 typedef SOCKET socket_t;
 #else
 #include <sys/socket.h>
@@ -12,6 +13,7 @@ typedef SOCKET socket_t;
 #include <signal.h>
 #include <unistd.h>
 #include <sys/wait.h>
+#include <fcntl.h>
 typedef int socket_t;
 #endif
 
@@ -26,15 +28,34 @@ typedef int socket_t;
 #include <thread>
 #include <filesystem>
 #include <functional>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <memory>
+#include <array>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
+#include <unordered_set>
 namespace fs = std::filesystem;
 #include <archive.h>
 #include <archive_entry.h>
 #include <nlohmann/json.hpp>
 using json = nlohmann::json;
+#ifdef MCAPI_SIMDJSON
+#include <simdjson.h>
+#endif
 
 namespace mcapi
 {
     inline fs::path datapath = ".mcapi";
+    inline int maxconnections = 32;
+    inline long metadatattl = 300;
+    inline int segmentcount = 4;
+    inline std::uint64_t segmentthreshold = 16 * 1024 * 1024;
     using argsmap = std::unordered_map<std::string, std::string>;
 
     enum class GETmode
@@ -44,6 +65,31 @@ namespace mcapi
         MemoryAndDisk
     };
 
+    enum class GETnext
+    {
+        Ready,
+        Done
+    };
+
+    enum class Syncmode
+    {
+        None,
+        PerFile,
+        Batch
+    };
+    inline Syncmode syncmode = Syncmode::Batch;
+
+    // - jre prefers the slim runtime image, minimal trims a jdk down to the modules the game needs with jlink.
+    enum class Javaprofile
+    {
+        Jdk,
+        Jre,
+        Minimal
+    };
+    inline Javaprofile javaprofile = Javaprofile::Jre;
+    inline bool systemjava = true;
+    inline long javapackagettl = 24 * 60 * 60;
+
     enum class OS
     {
         Windows,
@@ -58,6 +104,197 @@ namespace mcapi
         arm64
     };
 
+    struct GETrequest
+    {
+        std::string url;
+        std::string filename;
+        std::string folder;
+        std::string sha1;
+        std::uint64_t size = 0;
+    };
+
+    // - timeouts and the breaker cooldown are in seconds, delays in milliseconds.
+    struct Retrypolicy
+    {
+        int attempts = 4;
+        long connecttimeout = 15;
+        long totaltimeout = 0;
+        long lowspeedlimit = 1024;
+        long lowspeedtime = 30;
+        long basedelay = 500;
+        long maxdelay = 10000;
+        std::vector<long> statuses = {408, 425, 429, 500, 502, 503, 504};
+        std::vector<CURLcode> errors = {
+            CURLE_COULDNT_RESOLVE_HOST, CURLE_COULDNT_CONNECT, CURLE_OPERATION_TIMEDOUT, CURLE_SSL_CONNECT_ERROR,
+            CURLE_SEND_ERROR, CURLE_RECV_ERROR, CURLE_GOT_NOTHING, CURLE_PARTIAL_FILE, CURLE_HTTP2, CURLE_HTTP2_STREAM
+        };
+        int breakerthreshold = 5;
+        long breakercooldown = 30;
+    };
+    inline Retrypolicy retrypolicy;
+
+    struct Artifact
+    {
+        std::string url;
+        std::string path;
+        std::string sha1;
+        std::uint64_t size = 0;
+    };
+
+    // - an asset object is addressed by its sha1 alone, the url and path are derived when needed.
+    struct Asset
+    {
+        std::array<std::uint8_t, 20> hash{};
+        std::uint32_t size = 0;
+
+        std::string Hash() const;
+        std::string Url() const;
+        std::string Path() const;
+    };
+
+    // - the missing objects of an asset list, collapsed by hash and ordered largest first.
+    struct Assetplan
+    {
+        std::vector<Asset> missing;
+        size_t present = 0;
+        std::uint64_t bytes = 0;
+    };
+
+    // - a java runtime found on the host, described by its release file.
+    struct Javainstall
+    {
+        std::string home;
+        int major = 0;
+        Arch arch = Arch::x64;
+    };
+
+    // - one concrete adoptium build, pinned by its checksum.
+    struct Javapackage
+    {
+        std::string url;
+        std::string sha256;
+        std::uint64_t size = 0;
+        std::string release;
+    };
+
+    struct Manifestentry
+    {
+        std::string id;
+        std::string url;
+        std::string sha1;
+        std::string type;
+        std::string releasetime;
+    };
+
+    struct Library
+    {
+        std::string name;
+        std::string url;
+        std::string sha1;
+        std::uint64_t size = 0;
+        std::optional<Artifact> artifact;
+        std::unordered_map<std::string, Artifact> classifiers;
+        std::unordered_map<std::string, std::string> natives;
+        json rules;
+    };
+
+    // - an argument split once into literal text and ${name} variables, rendered without searching again.
+    struct Argsegment
+    {
+        std::string text;
+        bool variable = false;
+    };
+
+    struct Argtemplate
+    {
+        std::vector<Argsegment> segments;
+        size_t literalsize = 0;
+    };
+
+    struct Argument
+    {
+        std::vector<Argtemplate> values;
+        json rules;
+    };
+
+    // - one template per launch argument, everything but the user specific variables is already filled in.
+    struct Launchtemplate
+    {
+        std::vector<Argtemplate> arguments;
+    };
+
+    // - everything a relaunch needs once a version is installed, the launch template still holds the user placeholders.
+    struct Launchstamp
+    {
+        std::string javapath;
+        std::string nativesdir;
+        std::string classpath;
+        Launchtemplate launchtemplate;
+        std::string jsonpath;
+        std::string jsonsha1;
+        std::string sourcesha1;
+        std::string clientjar;
+        OS os = OS::Windows;
+        Arch arch = Arch::x64;
+    };
+
+    // - everything the launcher needs from a version json, parsed once and never modified after.
+    struct VersionProfile
+    {
+        std::string id;
+        std::string type;
+        std::string mainclass;
+        std::string assets;
+        std::optional<Artifact> assetindex;
+        std::optional<Artifact> client;
+        std::optional<Artifact> server;
+        std::vector<Library> libraries;
+        bool modernarguments = false;
+        std::vector<Argument> jvmarguments;
+        std::vector<Argument> gamearguments;
+        std::string minecraftarguments;
+        std::vector<Argtemplate> legacyarguments;
+        int javaversion = 8;
+    };
+
+    struct Sha1
+    {
+        Sha1() { Reset(); }
+        void Reset();
+        void Update(const void* data, size_t size);
+        std::string Hexdigest();
+
+    private:
+        void Transform(const std::uint8_t* block);
+
+        std::uint32_t state[5];
+        std::uint64_t length;
+        std::uint8_t buffer[64];
+        size_t buffered;
+    };
+
+    struct Sha256
+    {
+        Sha256() { Reset(); }
+        void Reset();
+        void Update(const void* data, size_t size);
+        std::string Hexdigest();
+
+    private:
+        void Transform(const std::uint8_t* block);
+
+        std::uint32_t state[8];
+        std::uint64_t length;
+        std::uint8_t buffer[64];
+        size_t buffered;
+    };
+
+    struct Connectionstats
+    {
+        std::uint64_t reused = 0;
+        std::uint64_t opened = 0;
+    };
+
     #ifdef _WIN32
     using Processhandle = HANDLE;
     #else
@@ -65,32 +302,74 @@ namespace mcapi
     #endif
 
     std::optional<std::string> GET(const std::wstring& url, GETmode mode = GETmode::MemoryOnly, const std::string& filename = "", const std::string& folder = "", const std::vector<std::string>& headers = {});
+    std::optional<std::string> GET(const GETrequest& request, GETmode mode = GETmode::DiskOnly, const std::vector<std::string>& headers = {});
+    bool GETpipe(const GETrequest& request, const std::function<bool(const void*, size_t)>& consume, const std::vector<std::string>& headers = {});
+    std::optional<std::string> GETcached(const std::wstring& url, const std::string& filename, const std::string& folder, long ttl = metadatattl);
+    std::vector<bool> GETmulti(const std::vector<GETrequest>& requests, int connections = maxconnections);
+    void GETstream(const std::function<GETnext(GETrequest&)>& next, const std::function<void(size_t, const GETrequest&, bool)>& done, int connections = maxconnections);
     std::optional<std::string> POST(const std::wstring& url, const std::string& body, const std::vector<std::string>& headers = {});
+    bool SyncDownloads();
+    Connectionstats GetConnectionStats();
+
+    std::string GetHexString(const std::uint8_t* bytes, size_t size);
+    bool GetHexBytes(const std::string& hex, std::uint8_t* bytes, size_t size);
+
+    fs::path GetStorePath(const std::string& sha1);
+    bool LinkFromStore(const std::string& sha1, const fs::path& target);
+    bool GetObjectInstalled(const fs::path& path, const std::string& sha1 = "", std::uint64_t size = 0);
+    void MarkObjectInstalled(const fs::path& path, const std::string& sha1 = "");
+    bool SaveInstalledIndex();
+    // - api only, for a host that wants to re-stat everything after files were touched behind the launcher's back.
+    size_t RescanInstalledIndex();
 
     bool GetRuleAllow(const json& lib, OS os);
+    bool GetRulesAllow(const json& rules, OS os);
     std::string GetOSRuleName(OS os);
     
     namespace vanilla
     {
         std::optional<std::string> DownloadVersionManifest();
+        std::optional<Manifestentry> GetManifestEntry(const std::string& manifestjson, const std::string& versionid);
+        std::optional<std::vector<Manifestentry>> GetManifestEntries(const std::string& manifestjson);
         std::optional<std::vector<std::string>> GetVersionsFromManifest(const std::string& manifestjson);
         std::optional<std::string> GetVersionJsonDownloadUrl(const std::string& manifestjson, const std::string& versionid);
-        std::optional<std::string> DownloadVersionJson(const std::string& jsonurl, const std::string& versionid);
+        std::optional<std::string> DownloadVersionJson(const std::string& jsonurl, const std::string& versionid, const std::string& sha1 = "");
+        std::optional<VersionProfile> GetVersionProfile(const std::string& versionjson);
         std::optional<std::string> GetClientJarDownloadUrl(const std::string& versionjson);
+        std::optional<std::string> GetClientJarDownloadUrl(const VersionProfile& profile);
+        std::optional<Artifact> GetClientJarArtifact(const std::string& versionjson);
+        std::optional<Artifact> GetClientJarArtifact(const VersionProfile& profile);
         std::optional<std::string> DownloadClientJar(const std::string& clienturl, const std::string& versionid);
+        std::optional<std::string> DownloadClientJar(const Artifact& client, const std::string& versionid);
         std::optional<std::string> GetAssetIndexJsonDownloadUrl(const std::string& versionjson);
+        std::optional<std::string> GetAssetIndexJsonDownloadUrl(const VersionProfile& profile);
         std::optional<std::string> DownloadAssetIndexJson(const std::string& indexurl, const std::string& versionid);
-        std::optional<std::vector<std::pair<std::string, std::string>>> GetLibrariesDownloadUrl(const std::string& versionjson, OS os);
-        std::optional<std::vector<std::string>> DownloadLibraries(const std::vector<std::pair<std::string, std::string>>& libraries, const std::string& versionid);
-        std::optional<std::vector<std::pair<std::string, std::string>>> GetAssetsDownloadUrl(const std::string& assetindexjson);
-        std::optional<std::vector<std::string>> DownloadAssets(const std::vector<std::pair<std::string, std::string>>& assets, const std::string& versionid);
-        std::optional<std::vector<std::pair<std::string, std::string>>> GetLibrariesNatives(const std::string& versionid, const std::string& versionjson, OS os, Arch arch);
-        std::optional<std::vector<std::string>> DownloadLibrariesNatives(const std::vector<std::pair<std::string, std::string>>& natives, const std::string& versionid);
+        std::optional<std::string> DownloadAssetIndexJson(const Artifact& assetindex, const std::string& versionid);
+        std::optional<std::vector<Artifact>> GetLibrariesDownloadUrl(const std::string& versionjson, OS os);
+        std::optional<std::vector<Artifact>> GetLibrariesDownloadUrl(const VersionProfile& profile, OS os);
+        std::optional<std::vector<std::string>> DownloadLibraries(const std::vector<Artifact>& libraries, const std::string& versionid);
+        std::optional<std::vector<Asset>> GetAssetsDownloadUrl(const std::string& assetindexjson);
+        Assetplan GetAssetsPlan(const std::vector<Asset>& assets);
+        std::optional<size_t> DownloadAssets(const Assetplan& plan);
+        std::optional<size_t> DownloadAssets(const std::vector<Asset>& assets, const std::string& versionid);
+        std::optional<std::vector<Artifact>> GetLibrariesNatives(const std::string& versionid, const std::string& versionjson, OS os, Arch arch);
+        std::optional<std::vector<Artifact>> GetLibrariesNatives(const std::string& versionid, const VersionProfile& profile, OS os, Arch arch);
+        std::optional<std::vector<std::string>> DownloadLibrariesNatives(const std::vector<Artifact>& natives, const std::string& versionid);
         std::optional<std::vector<std::string>> ExtractLibrariesNatives(const std::vector<std::string>& nativesjars, const std::string& versionid, OS os);
         std::optional<std::string> GetClassPath(const std::string& versionjson, const std::vector<std::string>& libraries, const std::string& clientjarpath, OS os);
+        std::optional<std::string> GetClassPath(const VersionProfile& profile, const std::vector<std::string>& libraries, const std::string& clientjarpath, OS os);
         std::optional<std::string> GetLaunchCommand(const std::string& username, const std::string& classpath, const std::string& versionjson, const std::string& versionid, OS os, const std::string& uuid = "00000000-0000-0000-0000-000000000000", const std::string& accesstoken = "0", const std::string& usertype = "mojang");
+        std::optional<std::string> GetLaunchCommand(const std::string& username, const std::string& classpath, const VersionProfile& profile, const std::string& versionid, OS os, const std::string& uuid = "00000000-0000-0000-0000-000000000000", const std::string& accesstoken = "0", const std::string& usertype = "mojang");
+        std::optional<Launchtemplate> GetLaunchTemplate(const std::string& classpath, const VersionProfile& profile, const std::string& versionid, OS os);
+        std::string GetLaunchCommandFromTemplate(const Launchtemplate& launchtemplate, const std::string& username, const std::string& uuid = "00000000-0000-0000-0000-000000000000", const std::string& accesstoken = "0", const std::string& usertype = "mojang");
+        std::optional<Launchstamp> GetLaunchStamp(const std::string& stampid, OS os, Arch arch, const std::string& jsonsha1 = "");
+        bool SaveLaunchStamp(const std::string& stampid, Launchstamp stamp);
         std::optional<std::string> GetServerJarDownloadUrl(const std::string& versionjson);
+        std::optional<std::string> GetServerJarDownloadUrl(const VersionProfile& profile);
+        std::optional<Artifact> GetServerJarArtifact(const std::string& versionjson);
+        std::optional<Artifact> GetServerJarArtifact(const VersionProfile& profile);
         std::optional<std::string> DownloadServerJar(const std::string& serverurl, const std::string& versionid);
+        std::optional<std::string> DownloadServerJar(const Artifact& server, const std::string& versionid);
     }
 
     namespace fabric
@@ -103,7 +382,8 @@ namespace mcapi
         std::optional<std::string> GetLoaderJsonDownloadUrl(const std::string& loaderid, const std::string& versionid);
         std::optional<std::string> DownloadLoaderJson(const std::string& jsonurl, const std::string& loaderid, const std::string& versionid);
         std::optional<std::string> GetLoaderJson(const std::string& loaderjson, const std::string& loaderid, const std::string& versionid);
-        std::optional<std::vector<std::pair<std::string, std::string>>> GetLoaderLibrariesDownloadUrl(const std::string& mergedjson, OS os);
+        std::optional<std::vector<Artifact>> GetLoaderLibrariesDownloadUrl(const std::string& mergedjson, OS os);
+        std::optional<std::vector<Artifact>> GetLoaderLibrariesDownloadUrl(const VersionProfile& profile, OS os);
     }
 
     namespace auth
@@ -130,8 +410,14 @@ namespace mcapi
     }
 
     std::optional<int> GetJavaVersion(const std::string& versionjson);
+    std::optional<int> GetJavaVersion(const VersionProfile& profile);
     std::optional<std::string> GetJavaDownloadUrl(int javaversion, OS os, Arch arch);
-    std::optional<std::string> DownloadJava(const std::string& javaurl, const std::string& versionid);
+    std::vector<Javainstall> GetSystemJavas();
+    std::optional<std::string> GetJavaRuntime(int javaversion, OS os, Arch arch, const std::string& versionid);
+    std::optional<Javapackage> GetJavaPackage(int javaversion, OS os, Arch arch);
+    std::optional<std::string> DownloadJava(const std::string& javaurl, int javaversion, OS os, Arch arch, const std::string& versionid, const std::string& sha256 = "", std::uint64_t size = 0);
+    std::optional<std::string> DownloadJava(const Javapackage& javapackage, int javaversion, OS os, Arch arch, const std::string& versionid);
+    size_t CollectJavaRuntimes();
 
     bool StartProcess(const std::string& javapath, const std::string& args, OS os, Processhandle* process, bool qt = false);
     bool StopProcess(Processhandle* process);
@@ -0,0 +1,356 @@
+#include "../api.hpp"
+
+// - microbenchmarks for the api, run against files of a real install from inside the launcher folder.
+// - usage: mcapi_bench launch [runs]
+// -        mcapi_bench assets <index json>... [runs]
+// -        mcapi_bench profile <version json>... [runs]
+
+using namespace mcapi;
+
+// - helpers.
+template <typename F>
+static double GetMicrosPerRun(int runs, F&& run)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < runs; ++i)
+        run();
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / runs;
+}
+
+// - a trailing number is the run count, everything before it is an input file.
+static int GetTrailingRuns(std::vector<std::string>& paths, int fallback)
+{
+    const std::string& last = paths.back();
+    if (paths.size() < 2 || !std::all_of(last.begin(), last.end(), [](unsigned char c) { return std::isdigit(c); }))
+        return fallback;
+
+    const int runs = std::max(std::atoi(last.c_str()), 1);
+    paths.pop_back();
+    return runs;
+}
+
+static std::optional<std::string> GetFile(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return std::nullopt;
+
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+// - the expander every launch ran before templates, kept as the baseline: parses the version json and
+// - searches each argument for every variable. assets live under datapath now, the rest is unchanged.
+static std::string GetReplacedArgs(std::string str, const argsmap& vars)
+{
+    for (const auto& [key, value] : vars)
+    {
+        std::string token = "${" + key + "}";
+        size_t pos;
+        while ((pos = str.find(token)) != std::string::npos)
+            str.replace(pos, token.size(), value);
+    }
+    return str;
+}
+
+static void GetArgsAppend(const json& node, std::vector<std::string>& out, const argsmap& vars, OS os)
+{
+    if (!GetRuleAllow(node, os))
+        return;
+
+    if (node.is_string())
+    {
+        out.push_back(GetReplacedArgs(node.get<std::string>(), vars));
+    }
+    else if (node.is_object() && node.contains("value"))
+    {
+        const auto& value = node["value"];
+        if (value.is_string())
+        {
+            out.push_back(GetReplacedArgs(value.get<std::string>(), vars));
+        }
+        else if (value.is_array())
+        {
+            for (const auto& v : value)
+                out.push_back(GetReplacedArgs(v.get<std::string>(), vars));
+        }
+    }
+}
+
+static std::optional<std::string> GetReplacedLaunchCommand(const std::string& username, const std::string& classpath, const std::string& versionjson, const std::string& versionid, OS os)
+{
+    try
+    {
+        json j = json::parse(versionjson);
+        if (!j.contains("mainClass"))
+            return std::nullopt;
+
+        std::string mainClass = j["mainClass"];
+
+        std::filesystem::path gamedir = datapath / "versions" / versionid;
+        std::filesystem::path assetsdir = datapath / "assets";
+        std::filesystem::path nativesdir = datapath / versionid / "natives";
+        std::filesystem::create_directories(gamedir);
+        std::filesystem::create_directories(nativesdir);
+
+        argsmap vars = {
+            {"auth_player_name", username},
+            {"version_name", versionid},
+            {"game_directory", gamedir.string()},
+            {"assets_root", assetsdir.string()},
+            {"game_assets", assetsdir.string()},
+            {"assets_index_name", j.value("assets", versionid)},
+            {"auth_uuid", "00000000-0000-0000-0000-000000000000"},
+            {"auth_access_token", "0"},
+            {"user_type", "mojang"},
+            {"version_type", j.value("type", "release")},
+            {"classpath", classpath},
+            {"natives_directory", nativesdir.string()},
+            {"launcher_name", "mcapi"},
+            {"launcher_version", "1.0"},
+            {"user_properties", "{}"},
+            {"clientid", "mcapi"},
+            {"auth_xuid", "0"}
+        };
+        std::vector<std::string> jvmargs;
+        std::vector<std::string> gameargs;
+
+        auto Getquotes = [](const std::string& str) -> std::string
+        {
+            if (str.find(' ') != std::string::npos || str.find('"') != std::string::npos)
+                return "\"" + str + "\"";
+            return str;
+        };
+
+        if (j.contains("arguments"))
+        {
+            const auto& args = j["arguments"];
+            if (args.contains("jvm"))
+                for (const auto& arguments : args["jvm"])
+                    GetArgsAppend(arguments, jvmargs, vars, os);
+            if (args.contains("game"))
+                for (const auto& arguments : args["game"])
+                    GetArgsAppend(arguments, gameargs, vars, os);
+        }
+        else if (j.contains("minecraftArguments"))
+        {
+            std::istringstream iss(GetReplacedArgs(j["minecraftArguments"], vars));
+            gameargs = {std::istream_iterator<std::string>{iss}, std::istream_iterator<std::string>{}};
+            jvmargs = {"-Xmx2G", "-Xms1G", "-Djava.library.path=" + nativesdir.string(), "-cp", classpath};
+        }
+
+        std::ostringstream cmd;
+        for (const auto& arguments : jvmargs) cmd << Getquotes(arguments) << " ";
+        cmd << mainClass << " ";
+        for (const auto& arguments : gameargs) cmd << Getquotes(arguments) << " ";
+        return cmd.str();
+    }
+    catch (...)
+    {
+        return std::nullopt;
+    }
+}
+
+// - every installed version of the manifest: the baseline expander against parsing into a template and rendering it,
+// - and against rendering a template kept from an earlier launch, which is what a stamped launch pays.
+static int BenchLaunch(int runs)
+{
+    const fs::path manifestpath = datapath / "version_manifest_v2.json";
+    auto manifestjson = GetFile(manifestpath.string());
+    if (!manifestjson)
+    {
+        std::cout << "Failed to read " << manifestpath.string() << "\n";
+        return 1;
+    }
+
+    auto entries = vanilla::GetManifestEntries(*manifestjson);
+    if (!entries)
+    {
+        std::cout << "Failed to parse " << manifestpath.string() << "\n";
+        return 1;
+    }
+
+    // - a classpath as long as the one of a modern version, it is the largest value in the command.
+    std::string classpath;
+    for (int i = 0; i < 120; ++i)
+        classpath += (i > 0 ? ":" : "") + (datapath / "libraries" / ("library" + std::to_string(i)) / "1.0" / "library-1.0.jar").string();
+
+    size_t versions = 0, differ = 0, length = 0;
+    double replacedtotal = 0, parsedtotal = 0, renderedtotal = 0;
+    for (const auto& entry : *entries)
+    {
+        const fs::path versionpath = datapath / "versions" / entry.id / (entry.id + ".json");
+        if (!fs::exists(versionpath))
+            continue;
+
+        auto versionjson = GetFile(versionpath.string());
+        auto profile = versionjson ? vanilla::GetVersionProfile(*versionjson) : std::nullopt;
+        auto launchtemplate = profile ? vanilla::GetLaunchTemplate(classpath, *profile, entry.id, OS::Linux) : std::nullopt;
+        if (!launchtemplate)
+        {
+            std::cout << "Failed to build launch template for " << entry.id << "\n";
+            return 1;
+        }
+
+        // - the two paths must build the same command, otherwise the timings compare different work.
+        auto replacedcmd = GetReplacedLaunchCommand("Player", classpath, *versionjson, entry.id, OS::Linux);
+        if (!replacedcmd || *replacedcmd != vanilla::GetLaunchCommandFromTemplate(*launchtemplate, "Player"))
+            ++differ;
+
+        const double replaced = GetMicrosPerRun(runs, [&]()
+        {
+            auto cmd = GetReplacedLaunchCommand("Player", classpath, *versionjson, entry.id, OS::Linux);
+            length += cmd ? cmd->size() : 0;
+        });
+        const double parsed = GetMicrosPerRun(runs, [&]()
+        {
+            auto cmd = vanilla::GetLaunchCommand("Player", classpath, *versionjson, entry.id, OS::Linux);
+            length += cmd ? cmd->size() : 0;
+        });
+        const double rendered = GetMicrosPerRun(runs, [&]()
+        {
+            length += vanilla::GetLaunchCommandFromTemplate(*launchtemplate, "Player").size();
+        });
+
+        std::cout << "launch " << entry.id << ", " << launchtemplate->arguments.size() << " arguments: replace " << replaced << " us, parse and render " << parsed << " us, render " << rendered << " us\n";
+        replacedtotal += replaced;
+        parsedtotal += parsed;
+        renderedtotal += rendered;
+        ++versions;
+    }
+
+    if (versions == 0)
+    {
+        std::cout << "No version json of the manifest under " << (datapath / "versions").string() << "\n";
+        return 1;
+    }
+
+    std::cout << versions << " versions, " << runs << " runs each, " << differ << " with a different command\n";
+    std::cout << "  replace (baseline): " << replacedtotal / versions << " us\n";
+    std::cout << "  parse and render:   " << parsedtotal / versions << " us\n";
+    std::cout << "  render template:    " << renderedtotal / versions << " us\n";
+    return length > 0 && differ == 0 ? 0 : 1;
+}
+
+// - GetAssetsDownloadUrl, simdjson when built with MCAPI_SIMDJSON, against a plain nlohmann parse and walk of the same index.
+static int BenchAssets(const std::vector<std::string>& indexpaths, int runs)
+{
+    #ifdef MCAPI_SIMDJSON
+    const char* backend = "simdjson";
+    #else
+    const char* backend = "nlohmann";
+    #endif
+
+    for (const auto& indexpath : indexpaths)
+    {
+        auto indexjson = GetFile(indexpath);
+        if (!indexjson)
+        {
+            std::cout << "Failed to read " << indexpath << "\n";
+            return 1;
+        }
+
+        auto assets = vanilla::GetAssetsDownloadUrl(*indexjson);
+        if (!assets)
+        {
+            std::cout << "Failed to parse " << indexpath << "\n";
+            return 1;
+        }
+
+        size_t count = 0;
+        const double api = GetMicrosPerRun(runs, [&]()
+        {
+            auto parsed = vanilla::GetAssetsDownloadUrl(*indexjson);
+            count += parsed ? parsed->size() : 0;
+        });
+        const double walked = GetMicrosPerRun(runs, [&]()
+        {
+            auto j = json::parse(*indexjson);
+            std::vector<std::pair<std::string, std::uint64_t>> objects;
+            objects.reserve(j["objects"].size());
+            for (const auto& entry : j["objects"].items())
+                objects.emplace_back(entry.value()["hash"].get<std::string>(), entry.value().value("size", std::uint64_t{0}));
+            count += objects.size();
+        });
+
+        std::cout << "assets " << fs::path(indexpath).filename().string() << ", " << indexjson->size() / 1024 << " KiB, " << assets->size() << " objects, " << runs << " runs\n";
+        std::cout << "  GetAssetsDownloadUrl (" << backend << "): " << api << " us\n";
+        std::cout << "  nlohmann parse and walk: " << walked << " us\n";
+        if (count == 0)
+            return 1;
+    }
+    return 0;
+}
+
+// - GetVersionProfile, simdjson when built with MCAPI_SIMDJSON, against the nlohmann dom it is built from otherwise.
+static int BenchProfile(const std::vector<std::string>& versionpaths, int runs)
+{
+    #ifdef MCAPI_SIMDJSON
+    const char* backend = "simdjson";
+    #else
+    const char* backend = "nlohmann";
+    #endif
+
+    for (const auto& versionpath : versionpaths)
+    {
+        auto versionjson = GetFile(versionpath);
+        if (!versionjson)
+        {
+            std::cout << "Failed to read " << versionpath << "\n";
+            return 1;
+        }
+
+        auto profile = vanilla::GetVersionProfile(*versionjson);
+        if (!profile)
+        {
+            std::cout << "Failed to parse " << versionpath << "\n";
+            return 1;
+        }
+
+        size_t count = 0;
+        const double api = GetMicrosPerRun(runs, [&]()
+        {
+            auto parsed = vanilla::GetVersionProfile(*versionjson);
+            count += parsed ? parsed->libraries.size() : 0;
+        });
+        const double parsed = GetMicrosPerRun(runs, [&]()
+        {
+            count += json::parse(*versionjson).size();
+        });
+
+        std::cout << "profile " << profile->id << ", " << versionjson->size() / 1024 << " KiB, " << profile->libraries.size() << " libraries, " << runs << " runs\n";
+        std::cout << "  GetVersionProfile (" << backend << "): " << api << " us\n";
+        std::cout << "  nlohmann parse only: " << parsed << " us\n";
+        if (count == 0)
+            return 1;
+    }
+    return 0;
+}
+// - end helpers.
+
+int main(int argc, char** argv)
+{
+    const std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "launch")
+        return BenchLaunch(argc > 2 ? std::max(std::atoi(argv[2]), 1) : 200);
+
+    if (mode == "assets" && argc > 2)
+    {
+        std::vector<std::string> indexpaths(argv + 2, argv + argc);
+        const int runs = GetTrailingRuns(indexpaths, 20);
+        return BenchAssets(indexpaths, runs);
+    }
+
+    if (mode == "profile" && argc > 2)
+    {
+        std::vector<std::string> versionpaths(argv + 2, argv + argc);
+        const int runs = GetTrailingRuns(versionpaths, 200);
+        return BenchProfile(versionpaths, runs);
+    }
+
+    std::cout << "usage: mcapi_bench launch [runs]\n";
+    std::cout << "       mcapi_bench assets <index json>... [runs]\n";
+    std::cout << "       mcapi_bench profile <version json>... [runs]\n";
+    return 1;
+}
@@ -3,6 +3,73 @@
 namespace mcapi
 {
 
+// - helpers.
+#ifdef MCAPI_SIMDJSON
+// - fabric meta lists every game and loader version, on-demand parsing only reads the fields we need.
+static std::optional<std::vector<std::string>> GetVersionsFromSimdjson(const std::string& metajson)
+{
+    static thread_local simdjson::ondemand::parser parser;
+    simdjson::padded_string padded(metajson);
+
+    simdjson::ondemand::document doc;
+    if (parser.iterate(padded).get(doc))
+        return std::nullopt;
+
+    simdjson::ondemand::array entries;
+    if (doc.get_array().get(entries))
+        return std::nullopt;
+
+    std::vector<std::string> ids;
+    for (auto entry : entries)
+    {
+        simdjson::ondemand::object obj;
+        if (entry.get_object().get(obj))
+            return std::nullopt;
+
+        std::string_view version;
+        if (obj["version"].get_string().get(version))
+            continue;
+
+        ids.emplace_back(version);
+    }
+    return ids;
+}
+
+static std::optional<std::string> GetLoaderVersionFromSimdjson(const std::string& loadermetajson)
+{
+    static thread_local simdjson::ondemand::parser parser;
+    simdjson::padded_string padded(loadermetajson);
+
+    simdjson::ondemand::document doc;
+    if (parser.iterate(padded).get(doc))
+        return std::nullopt;
+
+    // - only the first entry is read, the rest of the document is never parsed.
+    std::string_view version;
+    if (doc.at(0)["loader"]["version"].get_string().get(version))
+        return std::nullopt;
+
+    return std::string(version);
+}
+#endif
+
+// - group:artifact:version becomes group/path/artifact/version/artifact-version.jar.
+static std::optional<std::string> GetMavenPath(const std::string& name)
+{
+    size_t firstcolon = name.find(':');
+    size_t lastcolon = name.rfind(':');
+    if (firstcolon == std::string::npos || firstcolon == lastcolon)
+        return std::nullopt;
+
+    std::string group = name.substr(0, firstcolon);
+    std::string artifact = name.substr(firstcolon + 1, lastcolon - firstcolon - 1);
+    std::string version = name.substr(lastcolon + 1);
+
+    std::replace(group.begin(), group.end(), '.', '/');
+    return group + "/" + artifact + "/" + version + "/" + artifact + "-" + version + ".jar";
+}
+// - end helpers.
+
 namespace fabric
 {
 
@@ -37,24 +104,17 @@ json GetMergedJson(json parent, json child)
 std::optional<std::string> DownloadVersionMeta()
 {
     const fs::path metapath = datapath;
-    const fs::path metadiskpath = datapath / "version_meta.json";
-
-    if (fs::exists(metadiskpath) && fs::file_size(metadiskpath) > 0)
-    {
-        std::ifstream file(metadiskpath, std::ios::binary);
-        if (!file)
-            return std::nullopt;
 
-        std::ostringstream buffer;
-        buffer << file.rdbuf();
-        return buffer.str();
-    }
-
-    return GET(L"https://meta.fabricmc.net/v2/versions/game", GETmode::MemoryAndDisk, "version_meta.json", metapath.string()).value_or("");
+    return GETcached(L"https://meta.fabricmc.net/v2/versions/game", "version_meta.json", metapath.string()).value_or("");
 }
 
 std::optional<std::vector<std::string>> GetVersionsFromMeta(const std::string& metajson)
 {
+    #ifdef MCAPI_SIMDJSON
+    if (auto ids = GetVersionsFromSimdjson(metajson))
+        return ids;
+    #endif
+
     try
     {
         auto j = json::parse(metajson);
@@ -108,6 +168,11 @@ std::optional<std::string> DownloadLoaderMeta(const std::string& metaurl)
 
 std::optional<std::string> GetLoaderVersion(const std::string& loadermetajson)
 {
+    #ifdef MCAPI_SIMDJSON
+    if (auto version = GetLoaderVersionFromSimdjson(loadermetajson))
+        return version;
+    #endif
+
     try
     {
         auto j = json::parse(loadermetajson);
@@ -197,14 +262,14 @@ std::optional<std::string> GetLoaderJson(const std::string& loaderjson, const st
             return std::nullopt;
         }
 
-        auto parenturl = mcapi::vanilla::GetVersionJsonDownloadUrl(*manifest, parentid);
-        if (!parenturl)
+        auto parententry = mcapi::vanilla::GetManifestEntry(*manifest, parentid);
+        if (!parententry || parententry->url.empty())
         {
             return std::nullopt;
         }
 
         std::string parentjsonid = versionid + "-fabric-loader-vanilla-" + loaderid;
-        auto parentjson = mcapi::vanilla::DownloadVersionJson(parenturl.value(), parentjsonid);
+        auto parentjson = mcapi::vanilla::DownloadVersionJson(parententry->url, parentjsonid, parententry->sha1);
         if (!parentjson)
         {
             return std::nullopt;
@@ -220,60 +285,54 @@ std::optional<std::string> GetLoaderJson(const std::string& loaderjson, const st
     }
 }
 
-std::optional<std::vector<std::pair<std::string, std::string>>> GetLoaderLibrariesDownloadUrl(const std::string& mergedjson, OS os)
+std::optional<std::vector<Artifact>> GetLoaderLibrariesDownloadUrl(const std::string& mergedjson, OS os)
 {
-    try
-    {
-        auto j = json::parse(mergedjson);
-        if (!j.contains("libraries"))
-            return std::nullopt;
-    
-        std::vector<std::pair<std::string, std::string>> urls;
-        for (const auto& lib : j["libraries"])
-        {
-            if (!GetRuleAllow(lib, os))
-                continue;
+    auto profile = vanilla::GetVersionProfile(mergedjson);
+    if (!profile)
+        return std::nullopt;
 
-            // - vanilla libraries.
-            if (lib.contains("downloads") && lib["downloads"].contains("artifact"))
-            {
-                const auto& artifact = lib["downloads"]["artifact"];
+    return GetLoaderLibrariesDownloadUrl(*profile, os);
+}
 
-                std::string url = artifact["url"];
-                std::string path = artifact["path"];
+std::optional<std::vector<Artifact>> GetLoaderLibrariesDownloadUrl(const VersionProfile& profile, OS os)
+{
+    std::vector<Artifact> urls;
+    for (const auto& lib : profile.libraries)
+    {
+        if (!GetRulesAllow(lib.rules, os))
+            continue;
 
-                if (url.find("natives") == std::string::npos) 
+        // - vanilla libraries, an artifact without a path gets the maven path of its name.
+        if (lib.artifact)
+        {
+            if (lib.artifact->url.find("natives") == std::string::npos) 
+            {
+                Artifact artifact = *lib.artifact;
+                if (artifact.path.empty())
                 {
-                    urls.emplace_back(url, path);
+                    auto path = GetMavenPath(lib.name);
+                    if (!path)
+                    {
+                        std::cout << "Skipping library without a path: " << lib.name << "\n";
+                        continue;
+                    }
+                    artifact.path = *path;
                 }
+                urls.push_back(artifact);
             }
+        }
 
-            // - fabric libraries.
-            if (lib.contains("url") && lib.contains("name"))
-            {
-                std::string baseurl = lib["url"];
-                std::string name = lib["name"];
-
-                size_t firstcolon = name.find(':');
-                size_t lastcolon = name.rfind(':');
-                if (firstcolon == std::string::npos || firstcolon == lastcolon) 
-                    continue;
-    
-                std::string group = name.substr(0, firstcolon);
-                std::string artifact = name.substr(firstcolon + 1, lastcolon - firstcolon - 1);
-                std::string version = name.substr(lastcolon + 1);
-                
-                std::replace(group.begin(), group.end(), '.', '/');
-                std::string path = group + "/" + artifact + "/" + version + "/" + artifact + "-" + version + ".jar";
-                urls.emplace_back(baseurl + path, "libraries/" + path);
-            }
+        // - fabric libraries.
+        if (!lib.url.empty() && !lib.name.empty())
+        {
+            auto path = GetMavenPath(lib.name);
+            if (!path)
+                continue;
+
+            urls.push_back({lib.url + *path, "libraries/" + *path, lib.sha1, lib.size});
         }
-        return urls;
-    }
-    catch (...)
-    {
-        return std::nullopt;
     }
+    return urls;
 }
 
 }
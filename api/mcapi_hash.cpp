@@ -0,0 +1,316 @@
+#include "api.hpp"
+
+namespace mcapi
+{
+
+// - helpers.
+static std::uint32_t RotateLeft(std::uint32_t value, int bits)
+{
+    return (value << bits) | (value >> (32 - bits));
+}
+
+static std::uint32_t RotateRight(std::uint32_t value, int bits)
+{
+    return (value >> bits) | (value << (32 - bits));
+}
+
+static int GetHexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+static const std::uint32_t sha256rounds[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+// - end helpers.
+
+std::string GetHexString(const std::uint8_t* bytes, size_t size)
+{
+    static const char digits[] = "0123456789abcdef";
+
+    std::string hex;
+    hex.reserve(size * 2);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hex += digits[bytes[i] >> 4];
+        hex += digits[bytes[i] & 0x0f];
+    }
+    return hex;
+}
+
+bool GetHexBytes(const std::string& hex, std::uint8_t* bytes, size_t size)
+{
+    if (hex.size() != size * 2)
+        return false;
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        int high = GetHexValue(hex[i * 2]);
+        int low = GetHexValue(hex[i * 2 + 1]);
+        if (high < 0 || low < 0)
+            return false;
+        bytes[i] = static_cast<std::uint8_t>((high << 4) | low);
+    }
+    return true;
+}
+
+void Sha1::Reset()
+{
+    state[0] = 0x67452301;
+    state[1] = 0xefcdab89;
+    state[2] = 0x98badcfe;
+    state[3] = 0x10325476;
+    state[4] = 0xc3d2e1f0;
+    length = 0;
+    buffered = 0;
+}
+
+void Sha1::Transform(const std::uint8_t* block)
+{
+    std::uint32_t w[80];
+    for (int i = 0; i < 16; ++i)
+    {
+        w[i] = (static_cast<std::uint32_t>(block[i * 4]) << 24) |
+               (static_cast<std::uint32_t>(block[i * 4 + 1]) << 16) |
+               (static_cast<std::uint32_t>(block[i * 4 + 2]) << 8) |
+               (static_cast<std::uint32_t>(block[i * 4 + 3]));
+    }
+    for (int i = 16; i < 80; ++i)
+        w[i] = RotateLeft(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+    std::uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+    for (int i = 0; i < 80; ++i)
+    {
+        std::uint32_t f, k;
+        if (i < 20)
+        {
+            f = (b & c) | (~b & d);
+            k = 0x5a827999;
+        }
+        else if (i < 40)
+        {
+            f = b ^ c ^ d;
+            k = 0x6ed9eba1;
+        }
+        else if (i < 60)
+        {
+            f = (b & c) | (b & d) | (c & d);
+            k = 0x8f1bbcdc;
+        }
+        else
+        {
+            f = b ^ c ^ d;
+            k = 0xca62c1d6;
+        }
+
+        std::uint32_t temp = RotateLeft(a, 5) + f + e + k + w[i];
+        e = d;
+        d = c;
+        c = RotateLeft(b, 30);
+        b = a;
+        a = temp;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+}
+
+void Sha1::Update(const void* data, size_t size)
+{
+    const auto* bytes = static_cast<const std::uint8_t*>(data);
+    length += size;
+
+    if (buffered > 0)
+    {
+        const size_t take = std::min(size, sizeof(buffer) - buffered);
+        std::memcpy(buffer + buffered, bytes, take);
+        buffered += take;
+        bytes += take;
+        size -= take;
+
+        if (buffered < sizeof(buffer))
+            return;
+
+        Transform(buffer);
+        buffered = 0;
+    }
+
+    while (size >= sizeof(buffer))
+    {
+        Transform(bytes);
+        bytes += sizeof(buffer);
+        size -= sizeof(buffer);
+    }
+
+    std::memcpy(buffer, bytes, size);
+    buffered = size;
+}
+
+std::string Sha1::Hexdigest()
+{
+    const std::uint64_t bits = length * 8;
+
+    const std::uint8_t pad = 0x80;
+    Update(&pad, 1);
+
+    const std::uint8_t zero = 0;
+    while (buffered != 56)
+        Update(&zero, 1);
+
+    std::uint8_t lengthbytes[8];
+    for (int i = 0; i < 8; ++i)
+        lengthbytes[i] = static_cast<std::uint8_t>(bits >> (56 - i * 8));
+    Update(lengthbytes, sizeof(lengthbytes));
+
+    std::uint8_t digest[20];
+    for (int i = 0; i < 5; ++i)
+    {
+        digest[i * 4] = static_cast<std::uint8_t>(state[i] >> 24);
+        digest[i * 4 + 1] = static_cast<std::uint8_t>(state[i] >> 16);
+        digest[i * 4 + 2] = static_cast<std::uint8_t>(state[i] >> 8);
+        digest[i * 4 + 3] = static_cast<std::uint8_t>(state[i]);
+    }
+    Reset();
+
+    return GetHexString(digest, sizeof(digest));
+}
+
+void Sha256::Reset()
+{
+    state[0] = 0x6a09e667;
+    state[1] = 0xbb67ae85;
+    state[2] = 0x3c6ef372;
+    state[3] = 0xa54ff53a;
+    state[4] = 0x510e527f;
+    state[5] = 0x9b05688c;
+    state[6] = 0x1f83d9ab;
+    state[7] = 0x5be0cd19;
+    length = 0;
+    buffered = 0;
+}
+
+void Sha256::Transform(const std::uint8_t* block)
+{
+    std::uint32_t w[64];
+    for (int i = 0; i < 16; ++i)
+    {
+        w[i] = (static_cast<std::uint32_t>(block[i * 4]) << 24) |
+               (static_cast<std::uint32_t>(block[i * 4 + 1]) << 16) |
+               (static_cast<std::uint32_t>(block[i * 4 + 2]) << 8) |
+               (static_cast<std::uint32_t>(block[i * 4 + 3]));
+    }
+    for (int i = 16; i < 64; ++i)
+    {
+        std::uint32_t s0 = RotateRight(w[i - 15], 7) ^ RotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        std::uint32_t s1 = RotateRight(w[i - 2], 17) ^ RotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    std::uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    std::uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; ++i)
+    {
+        std::uint32_t s1 = RotateRight(e, 6) ^ RotateRight(e, 11) ^ RotateRight(e, 25);
+        std::uint32_t ch = (e & f) ^ (~e & g);
+        std::uint32_t temp1 = h + s1 + ch + sha256rounds[i] + w[i];
+        std::uint32_t s0 = RotateRight(a, 2) ^ RotateRight(a, 13) ^ RotateRight(a, 22);
+        std::uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+        std::uint32_t temp2 = s0 + maj;
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + temp1;
+        d = c;
+        c = b;
+        b = a;
+        a = temp1 + temp2;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
+
+void Sha256::Update(const void* data, size_t size)
+{
+    const auto* bytes = static_cast<const std::uint8_t*>(data);
+    length += size;
+
+    if (buffered > 0)
+    {
+        const size_t take = std::min(size, sizeof(buffer) - buffered);
+        std::memcpy(buffer + buffered, bytes, take);
+        buffered += take;
+        bytes += take;
+        size -= take;
+
+        if (buffered < sizeof(buffer))
+            return;
+
+        Transform(buffer);
+        buffered = 0;
+    }
+
+    while (size >= sizeof(buffer))
+    {
+        Transform(bytes);
+        bytes += sizeof(buffer);
+        size -= sizeof(buffer);
+    }
+
+    std::memcpy(buffer, bytes, size);
+    buffered = size;
+}
+
+std::string Sha256::Hexdigest()
+{
+    const std::uint64_t bits = length * 8;
+
+    const std::uint8_t pad = 0x80;
+    Update(&pad, 1);
+
+    const std::uint8_t zero = 0;
+    while (buffered != 56)
+        Update(&zero, 1);
+
+    std::uint8_t lengthbytes[8];
+    for (int i = 0; i < 8; ++i)
+        lengthbytes[i] = static_cast<std::uint8_t>(bits >> (56 - i * 8));
+    Update(lengthbytes, sizeof(lengthbytes));
+
+    std::uint8_t digest[32];
+    for (int i = 0; i < 8; ++i)
+    {
+        digest[i * 4] = static_cast<std::uint8_t>(state[i] >> 24);
+        digest[i * 4 + 1] = static_cast<std::uint8_t>(state[i] >> 16);
+        digest[i * 4 + 2] = static_cast<std::uint8_t>(state[i] >> 8);
+        digest[i * 4 + 3] = static_cast<std::uint8_t>(state[i]);
+    }
+    Reset();
+
+    return GetHexString(digest, sizeof(digest));
+}
+
+}
@@ -3,140 +3,1471 @@
 namespace mcapi
 {
 
+// - helper defines.
+static constexpr size_t maxpooledhandles = 64;
+static std::mutex sharelocks[CURL_LOCK_DATA_LAST];
+static std::mutex poolmutex;
+static std::vector<CURL*> pooledhandles;
+static std::atomic<std::uint64_t> connectionsreused{0};
+static std::atomic<std::uint64_t> connectionsopened{0};
+static std::mutex breakermutex;
+struct Breaker
+{
+    int failures = 0;
+    std::chrono::steady_clock::time_point since;
+    std::chrono::steady_clock::time_point openuntil;
+};
+static std::unordered_map<std::string, Breaker> breakers;
+// - piped downloads are split into ranges of this size, only the ranges in flight are held in memory.
+static constexpr std::uint64_t pipesegmentsize = 8 * 1024 * 1024;
+// - end helper defines.
+
 // - helpers.
+struct Sink
+{
+    std::string* memory = nullptr;
+    FILE* file = nullptr;
+    fs::path path;
+    fs::path temppath;
+
+    // - expected content, checked while the bytes arrive.
+    std::string sha1;
+    std::uint64_t size = 0;
+    std::uint64_t written = 0;
+    Sha1 hash;
+    bool mismatch = false;
+
+    // - piped transfers hand every chunk to a consumer instead of memory or disk.
+    const std::function<bool(const void*, size_t)>* pipe = nullptr;
+
+    // - response headers, and the validator a dropped download resumes against.
+    long status = 0;
+    std::string etag;
+    std::string lastmodified;
+    bool acceptranges = false;
+    std::uint64_t rangetotal = 0;
+    bool resume = false;
+    std::uint64_t resumefrom = 0;
+    std::string ifrange;
+
+    // - transfers of a GETstream batch leave the sync to the end of the batch.
+    bool batched = false;
+};
+
+static fs::path GetValidatorPath(const fs::path& path)
+{
+    fs::path validatorpath = path;
+    validatorpath += ".validator";
+    return validatorpath;
+}
+
+static bool RestartSink(Sink& sink)
+{
+    std::fclose(sink.file);
+    sink.file = std::fopen(sink.temppath.string().c_str(), "wb");
+    sink.written = 0;
+    sink.hash.Reset();
+    return sink.file != nullptr;
+}
+
 static size_t curl_write_callback(void* ptr, size_t size, size_t nmemb, void* userdata)
 {
-    auto* pair = static_cast<std::pair<std::string*, std::ofstream*>*>(userdata);
+    auto* sink = static_cast<Sink*>(userdata);
     const size_t total = size * nmemb;
 
-    if (pair->second && pair->second->is_open())
-        pair->second->write(static_cast<char*>(ptr), total);
+    // - an error page never reaches the file or the consumer, it does not count as delivered and a part on disk stays as it was.
+    if (sink->status >= 400 && !sink->memory)
+        return total;
 
-    if (pair->first)
-        pair->first->append(static_cast<char*>(ptr), total);
+    // - the server ignored the range or the file changed since, start over from byte zero.
+    if (sink->resumefrom > 0)
+    {
+        const bool whole = sink->status >= 200 && sink->status < 300 && sink->status != 206;
+        if (whole && (!sink->file || !RestartSink(*sink)))
+            return 0;
+        sink->resumefrom = 0;
+    }
+
+    sink->written += total;
+    if (sink->size > 0 && sink->written > sink->size)
+    {
+        sink->mismatch = true;
+        return 0;
+    }
+
+    if (!sink->sha1.empty())
+        sink->hash.Update(ptr, total);
+
+    if (sink->file && std::fwrite(ptr, 1, total, sink->file) != total)
+        return 0;
+
+    if (sink->pipe && !(*sink->pipe)(ptr, total))
+        return 0;
+
+    if (sink->memory)
+        sink->memory->append(static_cast<char*>(ptr), total);
 
     return total;
 }
-// - end helpers.
 
-std::optional<std::string> GET(const std::wstring& url, GETmode mode, const std::string& filename, const std::string& folder, const std::vector<std::string>& headers)
+static size_t curl_header_callback(char* buffer, size_t size, size_t nitems, void* userdata)
 {
-    std::string curlurl(url.begin(), url.end());
+    auto* sink = static_cast<Sink*>(userdata);
+    const size_t total = size * nitems;
 
-    std::ofstream out;
-    std::string response;
+    std::string line(buffer, total);
+    while (!line.empty() && (line.back() == '\r' || line.back() == '\n'))
+        line.pop_back();
 
-    if (mode == GETmode::DiskOnly || mode == GETmode::MemoryAndDisk)
+    // - every redirect hop starts a new status line, only the last response counts.
+    if (line.rfind("HTTP/", 0) == 0)
     {
-        std::string diskfile = filename;
+        auto space = line.find(' ');
+        sink->status = (space != std::string::npos) ? std::atol(line.c_str() + space + 1) : 0;
+        sink->etag.clear();
+        sink->lastmodified.clear();
+        sink->acceptranges = false;
+        sink->rangetotal = 0;
+        return total;
+    }
+
+    auto colon = line.find(':');
+    if (colon == std::string::npos)
+        return total;
+
+    std::string name = line.substr(0, colon);
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    std::string value = line.substr(colon + 1);
+    value.erase(0, value.find_first_not_of(" \t"));
+
+    if (name == "etag")
+        sink->etag = value;
+    else if (name == "last-modified")
+        sink->lastmodified = value;
+    else if (name == "accept-ranges")
+        sink->acceptranges = (value.find("bytes") != std::string::npos);
+    else if (name == "content-range" && value.find('/') != std::string::npos)
+        sink->rangetotal = std::strtoull(value.c_str() + value.find('/') + 1, nullptr, 10);
+
+    return total;
+}
+
+static fs::path GetDiskPath(const std::string& url, const std::string& filename, const std::string& folder)
+{
+    std::string diskfile = filename;
+    if (diskfile.empty())
+    {
+        auto slash = url.find_last_of('/');
+        if (slash != std::string::npos && slash + 1 < url.size())
+            diskfile = url.substr(slash + 1);
 
         if (diskfile.empty())
-        {
-            auto slash = curlurl.find_last_of('/');
-            if (slash != std::string::npos && slash + 1 < curlurl.size())
-                diskfile = curlurl.substr(slash + 1);
+            diskfile = "download.bin";
+    }
 
-            if (diskfile.empty())
-                diskfile = "download.bin";
+    if (folder.empty())
+        return fs::path(diskfile);
+    return fs::path(folder) / diskfile;
+}
+
+static void SyncFile(FILE* file)
+{
+    std::fflush(file);
+    #ifdef _WIN32
+    _commit(_fileno(file));
+    #else
+    fsync(fileno(file));
+    #endif
+}
+
+static bool WriteAt(FILE* file, const void* data, size_t size, std::uint64_t offset)
+{
+    #ifdef _WIN32
+    HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(file)));
+    OVERLAPPED overlapped{};
+    overlapped.Offset = static_cast<DWORD>(offset);
+    overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+    DWORD done = 0;
+    return WriteFile(handle, data, static_cast<DWORD>(size), &done, &overlapped) && done == size;
+    #else
+    const auto* bytes = static_cast<const char*>(data);
+    while (size > 0)
+    {
+        ssize_t done = pwrite(fileno(file), bytes, size, static_cast<off_t>(offset));
+        if (done <= 0)
+            return false;
+        bytes += done;
+        size -= static_cast<size_t>(done);
+        offset += static_cast<std::uint64_t>(done);
+    }
+    return true;
+    #endif
+}
+
+static bool Preallocate(FILE* file, std::uint64_t size)
+{
+    #ifdef _WIN32
+    return _chsize_s(_fileno(file), static_cast<__int64>(size)) == 0;
+    #elif defined(__linux__)
+    return posix_fallocate(fileno(file), 0, static_cast<off_t>(size)) == 0 || ftruncate(fileno(file), static_cast<off_t>(size)) == 0;
+    #else
+    return ftruncate(fileno(file), static_cast<off_t>(size)) == 0;
+    #endif
+}
+
+static void SyncDirectory(const fs::path& dir)
+{
+    #ifndef _WIN32
+    int fd = open(dir.empty() ? "." : dir.string().c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+    fsync(fd);
+    close(fd);
+    #endif
+}
+
+// - downloads are written to a sibling temp file and only renamed into place once complete.
+static bool ResumeSink(Sink& sink)
+{
+    std::ifstream validatorfile(GetValidatorPath(sink.path));
+    if (!validatorfile || !std::getline(validatorfile, sink.ifrange) || sink.ifrange.empty())
+        return false;
+
+    std::error_code ec;
+    const std::uint64_t partsize = fs::file_size(sink.temppath, ec);
+    if (ec || partsize == 0 || (sink.size > 0 && partsize >= sink.size))
+        return false;
+
+    // - the bytes already on disk still have to go through the hash.
+    if (!sink.sha1.empty())
+    {
+        std::ifstream part(sink.temppath, std::ios::binary);
+        char buffer[65536];
+        while (part.read(buffer, sizeof(buffer)) || part.gcount() > 0)
+            sink.hash.Update(buffer, static_cast<size_t>(part.gcount()));
+
+        if (part.bad())
+        {
+            sink.hash.Reset();
+            return false;
         }
+    }
+
+    sink.file = std::fopen(sink.temppath.string().c_str(), "ab");
+    if (!sink.file)
+    {
+        sink.hash.Reset();
+        return false;
+    }
+
+    sink.resumefrom = partsize;
+    sink.written = partsize;
+    return true;
+}
+
+static bool OpenSink(Sink& sink, const fs::path& path, bool resume = false)
+{
+    std::error_code ec;
+    if (path.has_parent_path())
+        fs::create_directories(path.parent_path(), ec);
+
+    sink.path = path;
+    sink.temppath = path;
+    sink.temppath += ".part";
+    sink.resume = resume;
+
+    if (resume && ResumeSink(sink))
+        return true;
+
+    sink.ifrange.clear();
+    fs::remove(GetValidatorPath(path), ec);
+
+    sink.file = std::fopen(sink.temppath.string().c_str(), "wb");
+    return sink.file != nullptr;
+}
+
+static void ExpectSink(Sink& sink, const GETrequest& request)
+{
+    sink.sha1 = request.sha1;
+    std::transform(sink.sha1.begin(), sink.sha1.end(), sink.sha1.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    sink.size = request.size;
+}
+
+static bool VerifySink(Sink& sink)
+{
+    if (sink.size > 0 && sink.written != sink.size)
+        sink.mismatch = true;
+    else if (!sink.sha1.empty() && sink.hash.Hexdigest() != sink.sha1)
+        sink.mismatch = true;
+
+    return !sink.mismatch;
+}
 
-        if (!folder.empty())
+static bool CloseSink(Sink& sink, bool success)
+{
+    if (!sink.file)
+        return false;
+
+    if (success)
+        success = VerifySink(sink);
+
+    if (success && std::fflush(sink.file) != 0)
+        success = false;
+
+    // - windows has no filesystem wide flush, so batch mode syncs per file there.
+    // - a single download is no batch, it is synced on its own instead of flushing the whole filesystem for one file.
+    #ifdef _WIN32
+    const bool syncnow = syncmode != Syncmode::None;
+    #else
+    const bool syncnow = syncmode == Syncmode::PerFile || (syncmode == Syncmode::Batch && !sink.batched);
+    #endif
+    if (success && syncnow)
+        SyncFile(sink.file);
+
+    std::fclose(sink.file);
+    sink.file = nullptr;
+
+    // - a resumed range that no longer fits the file is as good as a mismatch.
+    if (!sink.ifrange.empty() && sink.status == 416)
+        sink.mismatch = true;
+
+    std::error_code ec;
+    const fs::path validatorpath = GetValidatorPath(sink.path);
+    if (!success)
+    {
+        // - a dropped connection keeps the bytes it got so far, together with the validator to resume against.
+        // - a transient error page left the part untouched, it resumes against the validator it already had.
+        const bool transient = std::find(retrypolicy.statuses.begin(), retrypolicy.statuses.end(), sink.status) != retrypolicy.statuses.end();
+        std::string validator = (!sink.etag.empty() && sink.etag.rfind("W/", 0) != 0) ? sink.etag : sink.lastmodified;
+        if (transient || (validator.empty() && sink.status == 0))
+            validator = sink.ifrange;
+        if (sink.resume && !sink.mismatch && (sink.status < 400 || transient) && sink.written > 0 && !validator.empty())
         {
-            std::filesystem::create_directories(folder);
-            diskfile = folder + "/" + diskfile;
+            std::ofstream validatorfile(validatorpath, std::ios::trunc);
+            validatorfile << validator << "\n";
+            if (validatorfile)
+                return false;
         }
 
-        out.open(diskfile, std::ios::binary);
-        if (!out)
-            return std::nullopt;
+        fs::remove(sink.temppath, ec);
+        fs::remove(validatorpath, ec);
+        return false;
+    }
+    fs::remove(validatorpath, ec);
+
+    fs::rename(sink.temppath, sink.path, ec);
+    if (ec)
+    {
+        fs::remove(sink.path, ec);
+        fs::rename(sink.temppath, sink.path, ec);
+    }
+    if (ec)
+    {
+        fs::remove(sink.temppath, ec);
+        return false;
+    }
+
+    if (syncnow)
+        SyncDirectory(sink.path.parent_path());
+    return true;
+}
+
+// - a transfer only counts when curl finished and the server did not answer with an error page.
+static bool GetTransferOk(CURL* curl, CURLcode res)
+{
+    if (res != CURLE_OK)
+        return false;
+
+    long status = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+    return status < 400;
+}
+
+static void ShareLock(CURL*, curl_lock_data data, curl_lock_access, void*)
+{
+    sharelocks[data].lock();
+}
+
+static void ShareUnlock(CURL*, curl_lock_data data, void*)
+{
+    sharelocks[data].unlock();
+}
+
+// - process-wide dns cache and tls sessions shared by every handle.
+// - libcurl does not support sharing the connection cache between threads, so open connections stay with the pooled handle or multi that made them.
+static CURLSH* GetShare()
+{
+    static CURLSH* share = []()
+    {
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+
+        CURLSH* sh = curl_share_init();
+        if (!sh)
+            return sh;
+
+        curl_share_setopt(sh, CURLSHOPT_LOCKFUNC, ShareLock);
+        curl_share_setopt(sh, CURLSHOPT_UNLOCKFUNC, ShareUnlock);
+        curl_share_setopt(sh, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(sh, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        return sh;
+    }();
+    return share;
+}
+
+static CURL* AcquireHandle()
+{
+    CURLSH* share = GetShare();
+    {
+        std::lock_guard<std::mutex> lock(poolmutex);
+        if (!pooledhandles.empty())
+        {
+            CURL* curl = pooledhandles.back();
+            pooledhandles.pop_back();
+            return curl;
+        }
     }
 
     CURL* curl = curl_easy_init();
+    if (curl && share)
+        curl_easy_setopt(curl, CURLOPT_SHARE, share);
+    return curl;
+}
+
+static void ReleaseHandle(CURL* curl)
+{
     if (!curl)
+        return;
+
+    // - reset drops the per-request options but keeps the handle and its open connections alive.
+    curl_easy_reset(curl);
+    if (CURLSH* share = GetShare())
+        curl_easy_setopt(curl, CURLOPT_SHARE, share);
+
+    std::lock_guard<std::mutex> lock(poolmutex);
+    if (pooledhandles.size() < maxpooledhandles)
+    {
+        pooledhandles.push_back(curl);
+        return;
+    }
+    curl_easy_cleanup(curl);
+}
+
+static void CountConnections(CURL* curl)
+{
+    long connects = 0;
+    if (curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects) != CURLE_OK)
+        return;
+
+    if (connects > 0)
+        connectionsopened += static_cast<std::uint64_t>(connects);
+    else
+        connectionsreused++;
+}
+
+static std::string GetHost(const std::string& url)
+{
+    size_t start = url.find("://");
+    start = (start == std::string::npos) ? 0 : start + 3;
+
+    size_t end = url.find_first_of(":/?#", start);
+    return url.substr(start, end == std::string::npos ? std::string::npos : end - start);
+}
+
+// - a host that keeps failing is skipped for a while instead of eating every retry, this returns when it may be tried again.
+static std::optional<std::chrono::steady_clock::time_point> GetBreakerUntil(const std::string& url)
+{
+    std::lock_guard<std::mutex> lock(breakermutex);
+    auto it = breakers.find(GetHost(url));
+    if (it == breakers.end())
         return std::nullopt;
 
-    std::pair<std::string*, std::ofstream*> userdata
+    const Breaker& breaker = it->second;
+    if (breaker.failures < retrypolicy.breakerthreshold || std::chrono::steady_clock::now() >= breaker.openuntil)
+        return std::nullopt;
+    return breaker.openuntil;
+}
+
+// - a host that has not answered a single request for as many cooldowns as there are attempts is treated as down.
+static bool GetBreakerDown(const std::string& url)
+{
+    std::lock_guard<std::mutex> lock(breakermutex);
+    auto it = breakers.find(GetHost(url));
+    if (it == breakers.end() || it->second.failures < retrypolicy.breakerthreshold)
+        return false;
+    return std::chrono::steady_clock::now() - it->second.since >= std::chrono::seconds(retrypolicy.breakercooldown) * retrypolicy.attempts;
+}
+
+static bool GetBreakerOpen(const std::string& url)
+{
+    return GetBreakerUntil(url).has_value();
+}
+
+static void RecordBreaker(const std::string& url, bool failed)
+{
+    std::lock_guard<std::mutex> lock(breakermutex);
+    if (!failed)
     {
-        (mode == GETmode::MemoryOnly || mode == GETmode::MemoryAndDisk) ? &response : nullptr,
-        (mode == GETmode::DiskOnly  || mode == GETmode::MemoryAndDisk) ? &out : nullptr
-    };
+        breakers.erase(GetHost(url));
+        return;
+    }
+
+    Breaker& breaker = breakers[GetHost(url)];
+    if (breaker.failures++ == 0)
+        breaker.since = std::chrono::steady_clock::now();
+    if (breaker.failures >= retrypolicy.breakerthreshold)
+        breaker.openuntil = std::chrono::steady_clock::now() + std::chrono::seconds(retrypolicy.breakercooldown);
+}
+
+static bool GetRetryable(CURLcode res, long status)
+{
+    if (res != CURLE_OK)
+        return std::find(retrypolicy.errors.begin(), retrypolicy.errors.end(), res) != retrypolicy.errors.end();
+    return std::find(retrypolicy.statuses.begin(), retrypolicy.statuses.end(), status) != retrypolicy.statuses.end();
+}
 
-    curl_easy_setopt(curl, CURLOPT_URL, curlurl.c_str());
+// - exponential backoff with jitter, so parallel retries do not hit the server in lockstep.
+static std::chrono::milliseconds GetRetryDelay(int attempt)
+{
+    thread_local std::mt19937 random{std::random_device{}()};
+
+    long delay = retrypolicy.basedelay;
+    for (int i = 0; i < attempt && delay < retrypolicy.maxdelay; ++i)
+        delay *= 2;
+    delay = std::min(delay, retrypolicy.maxdelay);
+
+    std::uniform_int_distribution<long> jitter(delay / 2, std::max(delay, 1L));
+    return std::chrono::milliseconds(jitter(random));
+}
+
+static void SetCommonOptions(CURL* curl)
+{
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curl_write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &userdata);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, curl_header_callback);
     curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
 
+    // - timeouts, a stalled transfer is aborted once it stays below the speed limit for too long.
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, retrypolicy.connecttimeout);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, retrypolicy.totaltimeout);
+    curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, retrypolicy.lowspeedlimit);
+    curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, retrypolicy.lowspeedtime);
+
     // - security.
     curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
     curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
     curl_easy_setopt(curl, CURLOPT_USERAGENT, "Mozilla/5.0 (Windows NT 10.0; Win64; x64)");
+}
 
-    struct curl_slist* headerlist = nullptr;
-    for (const auto& h : headers)
-        headerlist = curl_slist_append(headerlist, h.c_str());
-    if (headerlist)
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headerlist);
+// - one in-flight transfer of GETmulti.
+struct Multitransfer
+{
+    CURL* curl = nullptr;
+    size_t index = 0;
+    int attempts = 0;
+    GETrequest request;
+    Sink sink;
+};
 
-    CURLcode res = curl_easy_perform(curl);
-    if (headerlist)
-        curl_slist_free_all(headerlist);
-    curl_easy_cleanup(curl);
+struct Multiretry
+{
+    std::chrono::steady_clock::time_point when;
+    size_t index = 0;
+    int attempts = 0;
+    GETrequest request;
+};
 
-    if (out.is_open())
-        out.close();
+static bool StartMultitransfer(CURLM* multi, Multitransfer& transfer, const GETrequest& request)
+{
+    transfer.sink = Sink{};
+    transfer.sink.batched = true;
+    ExpectSink(transfer.sink, request);
+    if (!OpenSink(transfer.sink, GetDiskPath(request.url, request.filename, request.folder)))
+        return false;
 
-    if (res != CURLE_OK)
-        return std::nullopt;
+    transfer.curl = AcquireHandle();
+    if (!transfer.curl)
+    {
+        CloseSink(transfer.sink, false);
+        return false;
+    }
+
+    SetCommonOptions(transfer.curl);
+    curl_easy_setopt(transfer.curl, CURLOPT_URL, request.url.c_str());
+    curl_easy_setopt(transfer.curl, CURLOPT_WRITEDATA, &transfer.sink);
+    curl_easy_setopt(transfer.curl, CURLOPT_HEADERDATA, &transfer.sink);
+    curl_easy_setopt(transfer.curl, CURLOPT_PRIVATE, &transfer);
+
+    // - wait for an existing connection to multiplex on instead of opening a new one.
+    curl_easy_setopt(transfer.curl, CURLOPT_PIPEWAIT, 1L);
+
+    if (curl_multi_add_handle(multi, transfer.curl) != CURLM_OK)
+    {
+        ReleaseHandle(transfer.curl);
+        transfer.curl = nullptr;
+        CloseSink(transfer.sink, false);
+        return false;
+    }
+    return true;
+}
+// - one byte range of a segmented download, written straight to its offset in the shared file.
+// - a piped download has no file, its ranges are held in memory until the consumer reaches them.
+// - every range reads its own response headers, ranges in flight at the same time must not share them.
+struct Segment
+{
+    CURL* curl = nullptr;
+    Sink* sink = nullptr;
+    Sink headers;
+    std::string memory;
+    std::uint64_t offset = 0;
+    std::uint64_t length = 0;
+    std::uint64_t written = 0;
+    std::uint64_t piped = 0;
+    std::string range;
+    int attempts = 0;
+    bool started = false;
+    bool retry = false;
+    std::chrono::steady_clock::time_point when;
+};
+
+static size_t curl_segment_callback(void* ptr, size_t size, size_t nmemb, void* userdata)
+{
+    auto* segment = static_cast<Segment*>(userdata);
+    const size_t total = size * nmemb;
+
+    // - an error page is dropped, the status decides whether the range is asked for again.
+    long status = 0;
+    curl_easy_getinfo(segment->curl, CURLINFO_RESPONSE_CODE, &status);
+    if (status >= 400)
+        return total;
+
+    // - a server that answers a range with the whole file can not be split.
+    if (status != 206 || segment->written + total > segment->length)
+        return 0;
+
+    // - every range reports the size of the whole file, one that differs from the expected size is a mismatch before any byte lands.
+    if (segment->headers.rangetotal > 0 && segment->sink->size > 0 && segment->headers.rangetotal != segment->sink->size)
+    {
+        segment->sink->mismatch = true;
+        return 0;
+    }
+
+    if (!segment->sink->file)
+        segment->memory.append(static_cast<char*>(ptr), total);
+    else if (!WriteAt(segment->sink->file, ptr, total, segment->offset + segment->written))
+        return 0;
+
+    segment->written += total;
+    return total;
+}
+
+// - a retried segment only asks for the bytes it is still missing.
+static bool StartSegment(CURLM* multi, Segment& segment, const std::string& url)
+{
+    segment.curl = AcquireHandle();
+    if (!segment.curl)
+        return false;
+
+    segment.range = std::to_string(segment.offset + segment.written) + "-" + std::to_string(segment.offset + segment.length - 1);
+    segment.headers = Sink{};
+
+    SetCommonOptions(segment.curl);
+    curl_easy_setopt(segment.curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(segment.curl, CURLOPT_RANGE, segment.range.c_str());
+    curl_easy_setopt(segment.curl, CURLOPT_WRITEFUNCTION, curl_segment_callback);
+    curl_easy_setopt(segment.curl, CURLOPT_WRITEDATA, &segment);
+    curl_easy_setopt(segment.curl, CURLOPT_HEADERDATA, &segment.headers);
+    curl_easy_setopt(segment.curl, CURLOPT_PRIVATE, &segment);
+
+    if (curl_multi_add_handle(multi, segment.curl) != CURLM_OK)
+    {
+        ReleaseHandle(segment.curl);
+        segment.curl = nullptr;
+        return false;
+    }
+    return true;
+}
+
+// - hands the ranges to the pipe in file order, the first unfinished one streams through as its bytes arrive.
+static bool FeedSegments(std::vector<Segment>& segments, size_t& current, Sink& sink, const std::function<bool(const void*, size_t)>& pipe)
+{
+    while (current < segments.size())
+    {
+        Segment& segment = segments[current];
+        if (segment.piped < segment.written)
+        {
+            const char* data = segment.memory.data() + segment.piped;
+            const size_t count = static_cast<size_t>(segment.written - segment.piped);
+            if (!sink.sha1.empty())
+                sink.hash.Update(data, count);
+            if (!pipe(data, count))
+                return false;
+            segment.piped = segment.written;
+        }
+
+        if (segment.piped < segment.length)
+            break;
+        std::string().swap(segment.memory);
+        ++current;
+    }
+    return true;
+}
+
+static bool GETsegmented(const GETrequest& request, const fs::path& path, std::uint64_t size, const std::function<bool(const void*, size_t)>* pipe = nullptr)
+{
+    Sink sink;
+    ExpectSink(sink, request);
+    if (!pipe)
+    {
+        if (!OpenSink(sink, path))
+            return false;
+
+        if (!Preallocate(sink.file, size))
+            return CloseSink(sink, false);
+    }
+
+    CURLM* multi = curl_multi_init();
+    if (!multi)
+        return CloseSink(sink, false);
+
+    // - every range gets its own connection, multiplexing them on one stream would defeat the point.
+    curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_NOTHING);
+
+    // - a file on disk is split once per connection, a pipe into fixed ranges of which only a window ahead of the consumer is fetched.
+    const std::uint64_t count = static_cast<std::uint64_t>(segmentcount);
+    const std::uint64_t chunk = pipe ? pipesegmentsize : (size + count - 1) / count;
+
+    std::vector<Segment> segments;
+    segments.reserve(static_cast<size_t>((size + chunk - 1) / chunk));
+    for (std::uint64_t offset = 0; offset < size; offset += chunk)
+    {
+        Segment segment;
+        segment.sink = &sink;
+        segment.offset = offset;
+        segment.length = std::min(chunk, size - offset);
+        segments.push_back(segment);
+    }
+
+    // - a failed range is fetched again on its own, the ranges that already arrived are kept.
+    // - ranges answered with different validators come from different files and can not be stitched together.
+    std::string validator;
+    size_t piping = 0;
+    int running = 0;
+    bool ok = true;
+    while (ok)
+    {
+        bool finished = true;
+        int timeout = 1000;
+        const auto now = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < segments.size() && ok; ++i)
+        {
+            Segment& segment = segments[i];
+            if (!segment.started && i < piping + count)
+            {
+                segment.started = true;
+                if (!StartSegment(multi, segment, request.url))
+                    ok = false;
+            }
+            else if (segment.retry && segment.when <= now)
+            {
+                segment.retry = false;
+                if (GetBreakerOpen(request.url) || !StartSegment(multi, segment, request.url))
+                    ok = false;
+            }
+            else if (segment.retry)
+            {
+                auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(segment.when - now).count();
+                timeout = static_cast<int>(std::clamp<long long>(wait, 0, timeout));
+            }
+
+            if (!segment.started || segment.curl || segment.retry)
+                finished = false;
+        }
+
+        if (!ok || finished)
+            break;
+
+        curl_multi_poll(multi, nullptr, 0, timeout, nullptr);
+        if (curl_multi_perform(multi, &running) != CURLM_OK)
+        {
+            ok = false;
+            break;
+        }
+
+        int queued = 0;
+        while (CURLMsg* msg = curl_multi_info_read(multi, &queued))
+        {
+            if (msg->msg != CURLMSG_DONE)
+                continue;
+
+            Segment* segment = nullptr;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &segment);
+
+            const CURLcode res = msg->data.result;
+            if (res == CURLE_OK)
+                CountConnections(msg->easy_handle);
+
+            long status = 0;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_RESPONSE_CODE, &status);
+            const bool retryable = GetRetryable(res, status) || (res == CURLE_OK && status < 400 && segment->written < segment->length);
+            RecordBreaker(request.url, retryable);
+
+            curl_multi_remove_handle(multi, msg->easy_handle);
+            ReleaseHandle(msg->easy_handle);
+            segment->curl = nullptr;
+
+            const std::string segmentvalidator = !segment->headers.etag.empty() ? segment->headers.etag : segment->headers.lastmodified;
+            if (res == CURLE_OK && status < 400 && !segmentvalidator.empty())
+            {
+                if (validator.empty())
+                    validator = segmentvalidator;
+                if (segmentvalidator != validator)
+                {
+                    ok = false;
+                    break;
+                }
+            }
+
+            if (res == CURLE_OK && status < 400 && segment->written == segment->length)
+                continue;
+
+            if (!retryable || ++segment->attempts >= retrypolicy.attempts)
+            {
+                ok = false;
+                break;
+            }
+            segment->retry = true;
+            segment->when = std::chrono::steady_clock::now() + GetRetryDelay(segment->attempts - 1);
+        }
+
+        if (ok && pipe && !FeedSegments(segments, piping, sink, *pipe))
+            ok = false;
+    }
+
+    for (auto& segment : segments)
+    {
+        if (segment.written != segment.length)
+            ok = false;
+
+        if (!segment.curl)
+            continue;
+
+        curl_multi_remove_handle(multi, segment.curl);
+        ReleaseHandle(segment.curl);
+        segment.curl = nullptr;
+    }
+    curl_multi_cleanup(multi);
+
+    if (ok && pipe && (!FeedSegments(segments, piping, sink, *pipe) || piping != segments.size()))
+        ok = false;
+
+    // - the consumer has every byte already, only the hash and size are left to check.
+    sink.written = size;
+    if (pipe)
+        return ok && VerifySink(sink);
+
+    if (!ok)
+        return CloseSink(sink, false);
+
+    // - the size is settled at this point, every range arrived whole and reported the expected total.
+    // - the ranges arrive out of order and sha1 can not be resumed from partial digests, so the hash is taken over the finished file.
+    // - that read hits the pages just written, it is the price of the parallel ranges, a file without a sha1 skips it.
+    std::error_code ec;
+    if (sink.mismatch || fs::file_size(sink.temppath, ec) != size || ec)
+        return CloseSink(sink, false);
+
+    if (!sink.sha1.empty())
+    {
+        std::ifstream part(sink.temppath, std::ios::binary);
+        char buffer[65536];
+        while (part.read(buffer, sizeof(buffer)) || part.gcount() > 0)
+            sink.hash.Update(buffer, static_cast<size_t>(part.gcount()));
+
+        if (part.bad())
+            return CloseSink(sink, false);
+    }
+    return CloseSink(sink, true);
+}
+// - the final response headers of a request, for callers that need more than the body.
+struct Responseinfo
+{
+    long status = 0;
+    std::string etag;
+    std::string lastmodified;
+};
+
+static std::optional<std::string> GETattempts(const GETrequest& request, GETmode mode, const std::vector<std::string>& headers, Responseinfo* info)
+{
+    const bool memory = (mode == GETmode::MemoryOnly || mode == GETmode::MemoryAndDisk);
+    const bool disk = (mode == GETmode::DiskOnly || mode == GETmode::MemoryAndDisk);
+
+    // - transient failures and files that do not match their expected hash or size are fetched again.
+    for (int attempt = 0; attempt < std::max(retrypolicy.attempts, 1); ++attempt)
+    {
+        if (attempt > 0)
+            std::this_thread::sleep_for(GetRetryDelay(attempt - 1));
+
+        if (GetBreakerOpen(request.url))
+            return std::nullopt;
+
+        Sink sink;
+        std::string response;
+        ExpectSink(sink, request);
+
+        if (memory)
+            sink.memory = &response;
+
+        // - only plain disk downloads can pick up a previous .part, memory copies need the full body.
+        if (disk)
+        {
+            if (!OpenSink(sink, GetDiskPath(request.url, request.filename, request.folder), mode == GETmode::DiskOnly))
+                return std::nullopt;
+        }
+
+        CURL* curl = AcquireHandle();
+        if (!curl)
+        {
+            CloseSink(sink, false);
+            return std::nullopt;
+        }
+
+        SetCommonOptions(curl);
+        curl_easy_setopt(curl, CURLOPT_URL, request.url.c_str());
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &sink);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &sink);
+
+        struct curl_slist* headerlist = nullptr;
+        for (const auto& h : headers)
+            headerlist = curl_slist_append(headerlist, h.c_str());
+
+        const std::string range = std::to_string(sink.resumefrom) + "-";
+        if (sink.resumefrom > 0)
+        {
+            curl_easy_setopt(curl, CURLOPT_RANGE, range.c_str());
+            headerlist = curl_slist_append(headerlist, ("If-Range: " + sink.ifrange).c_str());
+        }
+        if (headerlist)
+            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headerlist);
+
+        CURLcode res = curl_easy_perform(curl);
+        if (res == CURLE_OK)
+            CountConnections(curl);
+
+        long status = 0;
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+
+        bool ok;
+        if (sink.file)
+            ok = CloseSink(sink, GetTransferOk(curl, res));
+        else
+            ok = (res == CURLE_OK) && VerifySink(sink);
+
+        if (headerlist)
+            curl_slist_free_all(headerlist);
+        ReleaseHandle(curl);
+
+        const bool retryable = GetRetryable(res, status);
+        RecordBreaker(request.url, retryable);
+
+        if (info)
+            *info = {status, sink.etag, sink.lastmodified};
+
+        // - memory requests hand error pages back to the caller once retrying is pointless.
+        if (ok && !(sink.memory && !sink.file && retryable && attempt + 1 < retrypolicy.attempts))
+        {
+            if (mode == GETmode::DiskOnly)
+                return std::string{};
+            return response;
+        }
+
+        if (!sink.mismatch && !retryable)
+            return std::nullopt;
+    }
+    return std::nullopt;
+}
+// - end helpers.
+
+std::optional<std::string> GET(const std::wstring& url, GETmode mode, const std::string& filename, const std::string& folder, const std::vector<std::string>& headers)
+{
+    GETrequest request;
+    request.url = std::string(url.begin(), url.end());
+    request.filename = filename;
+    request.folder = folder;
+    return GET(request, mode, headers);
+}
+
+std::optional<std::string> GET(const GETrequest& request, GETmode mode, const std::vector<std::string>& headers)
+{
+    // - large files are split into ranges fetched in parallel, unless a previous attempt left a part to resume.
+    // - only a size known up front qualifies, small metadata files must not pay for a head request first.
+    if (mode == GETmode::DiskOnly && segmentcount > 1 && request.size >= segmentthreshold && headers.empty() && !GetBreakerOpen(request.url))
+    {
+        const fs::path path = GetDiskPath(request.url, request.filename, request.folder);
+
+        std::error_code ec;
+        if (!fs::exists(GetValidatorPath(path), ec) && GETsegmented(request, path, request.size))
+            return std::string{};
+    }
+
+    return GETattempts(request, mode, headers, nullptr);
+}
+
+bool GETpipe(const GETrequest& request, const std::function<bool(const void*, size_t)>& consume, const std::vector<std::string>& headers)
+{
+    // - a large pipe with a known size is fetched in parallel ranges, fed to the consumer in order.
+    // - only a run that never reached the consumer falls back to a single stream.
+    if (segmentcount > 1 && request.size >= segmentthreshold && headers.empty() && !GetBreakerOpen(request.url))
+    {
+        std::uint64_t piped = 0;
+        const std::function<bool(const void*, size_t)> counted = [&](const void* data, size_t size)
+        {
+            piped += size;
+            return consume(data, size);
+        };
+
+        if (GETsegmented(request, {}, request.size, &counted))
+            return true;
+        if (piped > 0)
+            return false;
+    }
+
+    // - bytes handed to the consumer cannot be taken back, a dropped transfer asks for the rest with a range request instead.
+    std::uint64_t delivered = 0;
+    Sha1 hash;
+    std::string validator;
+
+    for (int attempt = 0; attempt < std::max(retrypolicy.attempts, 1); ++attempt)
+    {
+        if (attempt > 0)
+            std::this_thread::sleep_for(GetRetryDelay(attempt - 1));
+
+        if (GetBreakerOpen(request.url))
+            return false;
+
+        Sink sink;
+        ExpectSink(sink, request);
+        sink.pipe = &consume;
+
+        // - the resumed bytes continue the running hash and size check, a server that answers with the whole file fails the write.
+        if (delivered > 0)
+        {
+            sink.written = delivered;
+            sink.hash = hash;
+            sink.resumefrom = delivered;
+            sink.ifrange = validator;
+        }
+
+        CURL* curl = AcquireHandle();
+        if (!curl)
+            return false;
+
+        SetCommonOptions(curl);
+        curl_easy_setopt(curl, CURLOPT_URL, request.url.c_str());
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &sink);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &sink);
+
+        struct curl_slist* headerlist = nullptr;
+        for (const auto& h : headers)
+            headerlist = curl_slist_append(headerlist, h.c_str());
+
+        const std::string range = std::to_string(delivered) + "-";
+        if (delivered > 0)
+        {
+            curl_easy_setopt(curl, CURLOPT_RANGE, range.c_str());
+            headerlist = curl_slist_append(headerlist, ("If-Range: " + validator).c_str());
+        }
+        if (headerlist)
+            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headerlist);
+
+        CURLcode res = curl_easy_perform(curl);
+        if (res == CURLE_OK)
+            CountConnections(curl);
+
+        long status = 0;
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+        const bool ok = GetTransferOk(curl, res) && VerifySink(sink);
+
+        if (headerlist)
+            curl_slist_free_all(headerlist);
+        ReleaseHandle(curl);
+
+        const bool retryable = GetRetryable(res, status);
+        RecordBreaker(request.url, retryable);
+
+        if (ok)
+            return true;
+
+        // - the validator of the response that delivered the bytes is what the next range is checked against.
+        if (sink.written > delivered)
+        {
+            const std::string current = (!sink.etag.empty() && sink.etag.rfind("W/", 0) != 0) ? sink.etag : sink.lastmodified;
+            if (!current.empty())
+                validator = current;
+            delivered = sink.written;
+            hash = sink.hash;
+        }
+
+        if (sink.mismatch || !retryable || (delivered > 0 && validator.empty()))
+            return false;
+    }
+    return false;
+}
+
+std::optional<std::string> GETcached(const std::wstring& url, const std::string& filename, const std::string& folder, long ttl)
+{
+    GETrequest request;
+    request.url = std::string(url.begin(), url.end());
+    request.filename = filename;
+    request.folder = folder;
+
+    const fs::path path = GetDiskPath(request.url, filename, folder);
+    fs::path cachepath = path;
+    cachepath += ".cache";
+
+    const long long now = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+    std::optional<std::string> cached;
+    json cache = json::object();
+    std::error_code ec;
+    if (fs::exists(path, ec) && fs::file_size(path, ec) > 0)
+    {
+        std::ifstream file(path, std::ios::binary);
+        std::ostringstream buffer;
+        buffer << file.rdbuf();
+        if (file)
+            cached = buffer.str();
+
+        // - a truncated or hand edited sidecar is a cache miss, the copy is revalidated from scratch.
+        try
+        {
+            std::ifstream cachefile(cachepath);
+            if (cachefile)
+                cache = json::parse(cachefile);
+            if (!cache.is_object())
+                cache = json::object();
+        }
+        catch (...)
+        {
+            cache = json::object();
+        }
+    }
+
+    const bool checked = cache.contains("checked") && cache["checked"].is_number_integer();
+    const bool etag = cache.contains("etag") && cache["etag"].is_string();
+    const bool lastmodified = cache.contains("lastmodified") && cache["lastmodified"].is_string();
+
+    // - inside the ttl the disk copy is trusted without asking the server.
+    if (cached && ttl > 0 && checked && now - cache["checked"].get<long long>() < ttl)
+        return cached;
+
+    std::vector<std::string> headers;
+    if (cached && etag)
+        headers.push_back("If-None-Match: " + cache["etag"].get<std::string>());
+    if (cached && lastmodified)
+        headers.push_back("If-Modified-Since: " + cache["lastmodified"].get<std::string>());
+
+    Responseinfo info;
+    auto response = GETattempts(request, GETmode::MemoryOnly, headers, &info);
+
+    // - offline or a server hiccup, keep working with what is on disk.
+    if (!response || (info.status != 304 && (info.status < 200 || info.status >= 300)))
+        return cached;
+
+    if (info.status == 304 && cached)
+    {
+        cache["checked"] = now;
+        std::ofstream(cachepath, std::ios::trunc) << cache.dump();
+        return cached;
+    }
+
+    Sink sink;
+    if (!OpenSink(sink, path) || std::fwrite(response->data(), 1, response->size(), sink.file) != response->size())
+    {
+        CloseSink(sink, false);
+        return response;
+    }
+    sink.written = response->size();
+    if (!CloseSink(sink, true))
+        return response;
 
-    if (mode == GETmode::DiskOnly)
-        return std::string{};
+    cache = json::object();
+    if (!info.etag.empty())
+        cache["etag"] = info.etag;
+    if (!info.lastmodified.empty())
+        cache["lastmodified"] = info.lastmodified;
+    cache["checked"] = now;
+    std::ofstream(cachepath, std::ios::trunc) << cache.dump();
 
     return response;
 }
 
-std::optional<std::string> POST(const std::wstring& url, const std::string& body, const std::vector<std::string>& headers)
+std::vector<bool> GETmulti(const std::vector<GETrequest>& requests, int connections)
 {
-    std::string curlurl(url.begin(), url.end());
+    std::vector<bool> results(requests.size(), false);
+    if (requests.empty())
+        return results;
 
-    std::string response;
+    size_t next = 0;
+    GETstream(
+        [&](GETrequest& request)
+        {
+            if (next >= requests.size())
+                return GETnext::Done;
+            request = requests[next++];
+            return GETnext::Ready;
+        },
+        [&](size_t index, const GETrequest&, bool ok) { results[index] = ok; },
+        connections);
+    return results;
+}
 
-    CURL* curl = curl_easy_init();
-    if (!curl)
-        return std::nullopt;
+void GETstream(const std::function<GETnext(GETrequest&)>& next, const std::function<void(size_t, const GETrequest&, bool)>& done, int connections)
+{
+    if (connections < 1)
+        connections = 1;
+
+    size_t sequence = 0;
+    bool exhausted = false;
 
-    std::pair<std::string*, std::ofstream*> userdata
+    // - whatever is left in the source fails, so every request still gets its done call.
+    auto Drain = [&]()
     {
-        &response, nullptr
+        GETrequest request;
+        while (!exhausted)
+        {
+            if (next(request) == GETnext::Done)
+                exhausted = true;
+            else
+                done(sequence++, request, false);
+        }
     };
 
-    curl_easy_setopt(curl, CURLOPT_URL, curlurl.c_str());
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, body.size());
+    CURLM* multi = curl_multi_init();
+    if (!multi)
+    {
+        Drain();
+        return;
+    }
 
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curl_write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &userdata);
-    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_multi_setopt(multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, static_cast<long>(connections));
+    curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(connections));
+    curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
 
-    struct curl_slist* headerlist = nullptr;
-    for (const auto& h : headers)
-        headerlist = curl_slist_append(headerlist, h.c_str());
-    if (headerlist)
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headerlist);
+    std::vector<Multitransfer> transfers(static_cast<size_t>(connections));
+    std::vector<Multitransfer*> idle;
+    for (auto& transfer : transfers)
+        idle.push_back(&transfer);
 
-    // - security.
-    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
-    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
-    curl_easy_setopt(curl, CURLOPT_USERAGENT, "Mozilla/5.0 (Windows NT 10.0; Win64; x64)");
+    int running = 0;
+    std::vector<Multiretry> retries;
 
-    CURLcode res = curl_easy_perform(curl);
-    if (headerlist)
-        curl_slist_free_all(headerlist);
-    curl_easy_cleanup(curl);
+    // - retries wait for their backoff to pass before they go back into the pool.
+    auto GetRetryDue = [&]() -> std::optional<Multiretry>
+    {
+        const auto now = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < retries.size(); ++i)
+        {
+            if (retries[i].when > now)
+                continue;
 
-    if (res != CURLE_OK)
+            Multiretry retry = std::move(retries[i]);
+            retries.erase(retries.begin() + static_cast<std::ptrdiff_t>(i));
+            return retry;
+        }
         return std::nullopt;
+    };
 
-    return response;
+    // - keep the pool of transfers full until the source runs dry.
+    auto Fill = [&]()
+    {
+        while (!idle.empty())
+        {
+            Multitransfer* transfer = idle.back();
+            if (auto due = GetRetryDue())
+            {
+                transfer->index = due->index;
+                transfer->attempts = due->attempts;
+                transfer->request = std::move(due->request);
+            }
+            else if (!exhausted)
+            {
+                if (next(transfer->request) == GETnext::Done)
+                {
+                    exhausted = true;
+                    break;
+                }
+                transfer->index = sequence++;
+                transfer->attempts = 0;
+            }
+            else
+            {
+                break;
+            }
+
+            // - a tripped breaker parks the transfer until the cooldown is over without using up an attempt, a short outage must not fail the whole queue.
+            // - the rest of the source most likely hits the same host, so filling stops here instead of draining it into the parked list.
+            if (auto until = GetBreakerUntil(transfer->request.url))
+            {
+                if (GetBreakerDown(transfer->request.url))
+                {
+                    done(transfer->index, transfer->request, false);
+                    continue;
+                }
+                retries.push_back({*until, transfer->index, transfer->attempts, std::move(transfer->request)});
+                break;
+            }
+
+            if (StartMultitransfer(multi, *transfer, transfer->request))
+                idle.pop_back();
+            else
+                done(transfer->index, transfer->request, false);
+        }
+    };
+
+    Fill();
+    while (true)
+    {
+        if (curl_multi_perform(multi, &running) != CURLM_OK)
+            break;
+
+        int queued = 0;
+        while (CURLMsg* msg = curl_multi_info_read(multi, &queued))
+        {
+            if (msg->msg != CURLMSG_DONE)
+                continue;
+
+            Multitransfer* transfer = nullptr;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &transfer);
+
+            if (msg->data.result == CURLE_OK)
+                CountConnections(msg->easy_handle);
+
+            const bool ok = CloseSink(transfer->sink, GetTransferOk(msg->easy_handle, msg->data.result));
+
+            long status = 0;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_RESPONSE_CODE, &status);
+            const bool retryable = GetRetryable(msg->data.result, status);
+            RecordBreaker(transfer->request.url, retryable);
+
+            if (!ok && (transfer->sink.mismatch || retryable) && ++transfer->attempts < retrypolicy.attempts)
+                retries.push_back({std::chrono::steady_clock::now() + GetRetryDelay(transfer->attempts - 1), transfer->index, transfer->attempts, std::move(transfer->request)});
+            else
+                done(transfer->index, transfer->request, ok);
+
+            curl_multi_remove_handle(multi, msg->easy_handle);
+            ReleaseHandle(msg->easy_handle);
+            transfer->curl = nullptr;
+            idle.push_back(transfer);
+        }
+
+        Fill();
+        if (idle.size() == transfers.size() && retries.empty() && exhausted)
+            break;
+
+        int timeout = 1000;
+        for (const auto& retry : retries)
+        {
+            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(retry.when - std::chrono::steady_clock::now()).count();
+            timeout = static_cast<int>(std::clamp<long long>(wait, 0, timeout));
+        }
+        curl_multi_poll(multi, nullptr, 0, timeout, nullptr);
+    }
+
+    for (auto& transfer : transfers)
+    {
+        if (!transfer.curl)
+            continue;
+
+        curl_multi_remove_handle(multi, transfer.curl);
+        ReleaseHandle(transfer.curl);
+        transfer.curl = nullptr;
+        CloseSink(transfer.sink, false);
+        done(transfer.index, transfer.request, false);
+    }
+    curl_multi_cleanup(multi);
+
+    for (const auto& retry : retries)
+        done(retry.index, retry.request, false);
+    Drain();
+
+    if (syncmode == Syncmode::Batch && sequence > 0)
+        SyncDownloads();
+}
+
+bool SyncDownloads()
+{
+    #ifdef _WIN32
+    return true;
+    #elif defined(__linux__)
+    int fd = open(datapath.empty() ? "." : datapath.string().c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    const bool synced = syncfs(fd) == 0;
+    close(fd);
+    return synced;
+    #else
+    sync();
+    return true;
+    #endif
+}
+
+std::optional<std::string> POST(const std::wstring& url, const std::string& body, const std::vector<std::string>& headers)
+{
+    std::string curlurl(url.begin(), url.end());
+
+    // - a post is only repeated when it never reached the server, anything else may already have been processed.
+    for (int attempt = 0; attempt < std::max(retrypolicy.attempts, 1); ++attempt)
+    {
+        if (attempt > 0)
+            std::this_thread::sleep_for(GetRetryDelay(attempt - 1));
+
+        if (GetBreakerOpen(curlurl))
+            return std::nullopt;
+
+        std::string response;
+
+        CURL* curl = AcquireHandle();
+        if (!curl)
+            return std::nullopt;
+
+        Sink sink;
+        sink.memory = &response;
+
+        SetCommonOptions(curl);
+        curl_easy_setopt(curl, CURLOPT_URL, curlurl.c_str());
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, body.size());
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &sink);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &sink);
+
+        struct curl_slist* headerlist = nullptr;
+        for (const auto& h : headers)
+            headerlist = curl_slist_append(headerlist, h.c_str());
+        if (headerlist)
+            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headerlist);
+
+        CURLcode res = curl_easy_perform(curl);
+        if (res == CURLE_OK)
+            CountConnections(curl);
+        if (headerlist)
+            curl_slist_free_all(headerlist);
+        ReleaseHandle(curl);
+
+        const bool unsent = (res == CURLE_COULDNT_RESOLVE_HOST || res == CURLE_COULDNT_CONNECT || res == CURLE_SSL_CONNECT_ERROR);
+        RecordBreaker(curlurl, unsent);
+
+        if (res == CURLE_OK)
+            return response;
+
+        if (!unsent)
+            return std::nullopt;
+    }
+    return std::nullopt;
+}
+
+Connectionstats GetConnectionStats()
+{
+    return {connectionsreused.load(), connectionsopened.load()};
 }
 
 }
@@ -3,53 +3,554 @@
 namespace mcapi
 {
 
-std::optional<int> GetJavaVersion(const std::string& versionjson)
+// - helper defines.
+static constexpr size_t pipecapacity = 8 * 1024 * 1024;
+static constexpr size_t pipechunk = 256 * 1024;
+
+static std::mutex referencemutex;
+static std::mutex systemmutex;
+static std::optional<std::vector<Javainstall>> systemjavas;
+
+// - top level folders of a jdk the game never touches.
+static const char* const skippedmembers[] = {"man", "include", "demo", "sample", "src.zip"};
+
+// - modules the game and its loaders use, linked when the jdk provides them.
+static const char* const minimalmodules[] = {
+    "java.base", "java.compiler", "java.desktop", "java.instrument", "java.logging", "java.management",
+    "java.naming", "java.net.http", "java.scripting", "java.security.jgss", "java.sql", "java.xml",
+    "jdk.crypto.ec", "jdk.localedata", "jdk.management", "jdk.unsupported", "jdk.zipfs"
+};
+
+struct Pipebuffer
+{
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::string> chunks;
+    std::string current;
+    size_t buffered = 0;
+    bool closed = false;
+    bool aborted = false;
+};
+// - end helper defines.
+
+// - helpers.
+// - runtimes are shared by every version that needs the same major release, stored as runtime/<major>-<os>-<arch>-<profile>/<release> under datapath.
+static fs::path GetRuntimePath()
+{
+    return datapath / "runtime";
+}
+
+static bool PushPipe(Pipebuffer& pipe, const void* data, size_t size)
+{
+    std::unique_lock<std::mutex> lock(pipe.mutex);
+    pipe.changed.wait(lock, [&]() { return pipe.buffered < pipecapacity || pipe.aborted; });
+    if (pipe.aborted)
+        return false;
+
+    // - curl hands over small pieces, they are merged so libarchive gets fewer and larger reads.
+    if (!pipe.chunks.empty() && pipe.chunks.back().size() < pipechunk)
+        pipe.chunks.back().append(static_cast<const char*>(data), size);
+    else
+        pipe.chunks.emplace_back(static_cast<const char*>(data), size);
+
+    pipe.buffered += size;
+    pipe.changed.notify_all();
+    return true;
+}
+
+// - returns the number of bytes available at data, 0 once the stream ended and -1 when it was aborted.
+static la_ssize_t PullPipe(Pipebuffer& pipe, const void** data)
+{
+    std::unique_lock<std::mutex> lock(pipe.mutex);
+    pipe.changed.wait(lock, [&]() { return !pipe.chunks.empty() || pipe.closed || pipe.aborted; });
+    if (pipe.aborted)
+        return -1;
+    if (pipe.chunks.empty())
+        return 0;
+
+    pipe.current = std::move(pipe.chunks.front());
+    pipe.chunks.pop_front();
+    pipe.buffered -= pipe.current.size();
+    pipe.changed.notify_all();
+
+    *data = pipe.current.data();
+    return static_cast<la_ssize_t>(pipe.current.size());
+}
+
+static void ClosePipe(Pipebuffer& pipe, bool abort)
+{
+    std::lock_guard<std::mutex> lock(pipe.mutex);
+    pipe.closed = true;
+    if (abort)
+        pipe.aborted = true;
+    pipe.changed.notify_all();
+}
+
+static la_ssize_t ReadPipe(struct archive* a, void* userdata, const void** data)
+{
+    la_ssize_t size = PullPipe(*static_cast<Pipebuffer*>(userdata), data);
+    if (size < 0)
+        archive_set_error(a, EIO, "download aborted");
+    return size;
+}
+
+// - java 8 has no jlink to trim with, the jre image is the smallest it gets there.
+static Javaprofile GetJavaProfile(int javaversion)
+{
+    if (javaprofile == Javaprofile::Minimal && javaversion < 11)
+        return Javaprofile::Jre;
+    return javaprofile;
+}
+
+// - member paths start with the release folder, mac archives nest the runtime in Contents/Home below it.
+static bool GetMemberWanted(const fs::path& entrypath, Javaprofile profile)
+{
+    if (profile == Javaprofile::Jdk)
+        return true;
+
+    auto it = entrypath.begin();
+    if (it == entrypath.end() || ++it == entrypath.end())
+        return true;
+
+    if (*it == "Contents")
+    {
+        if (++it == entrypath.end() || *it != "Home" || ++it == entrypath.end())
+            return true;
+    }
+
+    // - the jlink input keeps its jmods, a plain runtime never needs them.
+    if (*it == "jmods")
+        return profile == Javaprofile::Minimal;
+
+    for (const char* skipped : skippedmembers)
+    {
+        if (*it == skipped)
+            return false;
+    }
+
+    // - the sources sit in lib on java 8.
+    return !(*it == "lib" && ++it != entrypath.end() && *it == "src.zip");
+}
+
+static bool ExtractPipe(Pipebuffer& pipe, const fs::path& targetdir, Javaprofile profile)
+{
+    struct archive* a = archive_read_new();
+    archive_read_support_format_all(a);
+    archive_read_support_filter_all(a);
+
+    if (archive_read_open(a, &pipe, nullptr, ReadPipe, nullptr) != ARCHIVE_OK)
+    {
+        std::cout << "Failed to open java runtime archive: " << archive_error_string(a) << "\n";
+        archive_read_free(a);
+        return false;
+    }
+
+    bool ok = true;
+    struct archive_entry* entry;
+    int r;
+
+    while ((r = archive_read_next_header(a, &entry)) == ARCHIVE_OK)
+    {
+        const char* pathname = archive_entry_pathname(entry);
+        if (!pathname)
+        {
+            archive_read_data_skip(a);
+            continue;
+        }
+        fs::path entrypath(pathname);
+
+        if (entrypath.is_absolute() || entrypath.string().find("..") != std::string::npos || !GetMemberWanted(entrypath, profile))
+        {
+            archive_read_data_skip(a);
+            continue;
+        }
+        fs::path outpath = targetdir / entrypath;
+
+        if (archive_entry_filetype(entry) == AE_IFDIR)
+        {
+            fs::create_directories(outpath);
+            continue;
+        }
+
+        fs::create_directories(outpath.parent_path());
+
+        std::ofstream out(outpath, std::ios::binary);
+        if (!out)
+        {
+            ok = false;
+            break;
+        }
+
+        const void* buff;
+        size_t size;
+        la_int64_t offset;
+
+        while ((r = archive_read_data_block(a, &buff, &size, &offset)) == ARCHIVE_OK)
+            out.write(static_cast<const char*>(buff), size);
+
+        if (r != ARCHIVE_EOF || !out)
+        {
+            ok = false;
+            break;
+        }
+        out.close();
+
+        // - keep the executable bits, jlink and the launchers run straight from the extracted tree.
+        #ifndef _WIN32
+        std::error_code ec;
+        fs::permissions(outpath, static_cast<fs::perms>(archive_entry_perm(entry)) & fs::perms::mask, ec);
+        #endif
+    }
+
+    if (ok && r != ARCHIVE_EOF)
+        ok = false;
+    if (!ok)
+        std::cout << "Failed to extract java runtime: " << (archive_error_string(a) ? archive_error_string(a) : "write error") << "\n";
+
+    archive_read_free(a);
+    return ok;
+}
+
+static std::string GetRuntimeKey(int javaversion, OS os, Arch arch)
+{
+    const char* osStr = (os == OS::Windows) ? "windows" : (os == OS::Macos) ? "mac" : "linux";
+    const char* archStr = (arch == Arch::x64) ? "x64" : (arch == Arch::arm64) ? "aarch64" : "x32";
+
+    const Javaprofile profile = GetJavaProfile(javaversion);
+    const char* profileStr = (profile == Javaprofile::Jdk) ? "jdk" : (profile == Javaprofile::Jre) ? "jre" : "minimal";
+    return std::to_string(javaversion) + "-" + osStr + "-" + archStr + "-" + profileStr;
+}
+
+// - only folders GetRuntimeKey could have named are ever collected.
+static bool GetRuntimeKeyValid(const std::string& name)
+{
+    std::vector<std::string> parts;
+    size_t start = 0;
+    while (true)
+    {
+        size_t dash = name.find('-', start);
+        parts.push_back(name.substr(start, dash == std::string::npos ? std::string::npos : dash - start));
+        if (dash == std::string::npos)
+            break;
+        start = dash + 1;
+    }
+    if (parts.size() != 4 || parts[0].empty() || !std::all_of(parts[0].begin(), parts[0].end(), [](unsigned char c) { return std::isdigit(c); }))
+        return false;
+
+    const auto oneof = [](const std::string& part, std::initializer_list<const char*> options)
+    {
+        return std::any_of(options.begin(), options.end(), [&](const char* option) { return part == option; });
+    };
+    return oneof(parts[1], {"windows", "mac", "linux"}) && oneof(parts[2], {"x64", "aarch64", "x32"}) && oneof(parts[3], {"jdk", "jre", "minimal"});
+}
+
+// - mac archives nest the runtime inside a bundle.
+static bool GetRuntimeComplete(const fs::path& javahome)
 {
+    return fs::is_directory(javahome / "bin") || fs::is_directory(javahome / "Contents" / "Home" / "bin");
+}
+
+static fs::path GetRuntimeHome(const fs::path& javaroot)
+{
+    const fs::path bundlehome = javaroot / "Contents" / "Home";
+    return fs::is_directory(bundlehome) ? bundlehome : javaroot;
+}
+
+// - links only the modules the game needs into javahome, from an extracted jdk that still has its jmods.
+static bool LinkMinimalRuntime(const fs::path& jdkroot, const fs::path& javahome, OS os)
+{
+    const fs::path jdkhome = GetRuntimeHome(jdkroot);
+    const fs::path jlink = jdkhome / "bin" / (os == OS::Windows ? "jlink.exe" : "jlink");
+    const fs::path jmods = jdkhome / "jmods";
+    if (!fs::exists(jlink) || !fs::is_directory(jmods))
+        return false;
+
+    std::string modules;
+    for (const char* module : minimalmodules)
+    {
+        if (!fs::exists(jmods / (std::string(module) + ".jmod")))
+            continue;
+
+        if (!modules.empty())
+            modules += ",";
+        modules += module;
+    }
+
+    std::string cmd = "\"" + fs::absolute(jlink).string() + "\" --module-path \"" + fs::absolute(jmods).string() + "\""
+        " --add-modules " + modules + " --strip-debug --no-man-pages --no-header-files --compress=2"
+        " --output \"" + fs::absolute(javahome).string() + "\"";
+
+    // - cmd.exe strips the outer quotes of the whole line.
+    if (os == OS::Windows)
+        cmd = "\"" + cmd + "\"";
+
+    std::error_code ec;
+    if (std::system(cmd.c_str()) == 0 && GetRuntimeComplete(javahome))
+        return true;
+
+    fs::remove_all(javahome, ec);
+    return false;
+}
+
+// - references map a version id to the runtime folder it launches with, relative to the runtime store.
+static json LoadReferences()
+{
+    std::ifstream in(GetRuntimePath() / "references.json");
+    if (!in)
+        return json::object();
+
     try
     {
-        auto j = json::parse(versionjson);
-            
-        int major = 8;
-        if (j.contains("javaVersion") && j["javaVersion"].contains("majorVersion"))
+        json references = json::parse(in);
+        if (references.is_object())
+            return references;
+    }
+    catch (...) {}
+    return json::object();
+}
+
+static bool SaveReferences(const json& references)
+{
+    std::error_code ec;
+    fs::create_directories(GetRuntimePath(), ec);
+
+    const fs::path referencepath = GetRuntimePath() / "references.json";
+    fs::path temppath = referencepath;
+    temppath += ".part";
+    {
+        std::ofstream out(temppath, std::ios::trunc);
+        if (!out)
+            return false;
+
+        out << references.dump(4);
+        if (!out)
+            return false;
+    }
+
+    fs::rename(temppath, referencepath, ec);
+    if (ec)
+    {
+        fs::remove(temppath, ec);
+        return false;
+    }
+    return true;
+}
+
+static void AddReference(const std::string& versionid, const fs::path& javahome)
+{
+    std::lock_guard<std::mutex> lock(referencemutex);
+
+    json references = LoadReferences();
+    const std::string runtime = javahome.lexically_relative(GetRuntimePath()).generic_string();
+    if (references.value(versionid, "") == runtime)
+        return;
+
+    references[versionid] = runtime;
+    if (!SaveReferences(references))
+        std::cout << "Failed to save java runtime references.\n";
+}
+
+// - folders that hold one runtime per subfolder, plus JAVA_HOME itself.
+static std::vector<fs::path> GetSystemJavaHomes()
+{
+    std::vector<fs::path> homes;
+    std::vector<fs::path> parents;
+
+    if (const char* javahome = std::getenv("JAVA_HOME"))
+        homes.push_back(javahome);
+
+    #ifdef _WIN32
+    for (const char* variable : {"ProgramFiles", "ProgramW6432"})
+    {
+        if (const char* programfiles = std::getenv(variable))
         {
-            major = j["javaVersion"]["majorVersion"].get<int>();
+            for (const char* vendor : {"Java", "Eclipse Adoptium", "Microsoft", "Zulu", "Amazon Corretto", "BellSoft"})
+                parents.push_back(fs::path(programfiles) / vendor);
         }
-        switch (major)
+    }
+    if (const char* userprofile = std::getenv("USERPROFILE"))
+        parents.push_back(fs::path(userprofile) / ".jdks");
+    #else
+    const char* userhome = std::getenv("HOME");
+    for (const char* parent : {"/usr/lib/jvm", "/usr/lib64/jvm", "/usr/java", "/opt/java", "/Library/Java/JavaVirtualMachines"})
+        parents.push_back(parent);
+
+    if (const char* sdkman = std::getenv("SDKMAN_DIR"))
+        parents.push_back(fs::path(sdkman) / "candidates" / "java");
+    else if (userhome)
+        parents.push_back(fs::path(userhome) / ".sdkman" / "candidates" / "java");
+
+    if (userhome)
+    {
+        parents.push_back(fs::path(userhome) / ".jdks");
+        parents.push_back(fs::path(userhome) / "Library" / "Java" / "JavaVirtualMachines");
+    }
+    #endif
+
+    for (const auto& parent : parents)
+    {
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator(parent, ec))
         {
-            case 8:
-            case 16:
-            case 17:
-            case 21:
-            case 25:
-                return major;
-            default:
-                return 8;
+            // - sdkman keeps a "current" link next to the real folders.
+            if (entry.is_directory() && !entry.is_symlink())
+                homes.push_back(GetRuntimeHome(entry.path()));
         }
     }
-    catch (...)
+    return homes;
+}
+
+// - "1.8.0_392" is java 8, anything newer starts with its major version.
+static int GetReleaseMajor(const std::string& version)
+{
+    int major = std::atoi(version.c_str());
+    if (major == 1)
     {
-        return 8;
+        auto dot = version.find('.');
+        if (dot != std::string::npos)
+            major = std::atoi(version.c_str() + dot + 1);
     }
+    return major;
 }
 
-std::optional<std::string> GetJavaDownloadUrl(int javaversion, OS os, Arch arch)
+static std::optional<Javainstall> ParseReleaseFile(const fs::path& home)
+{
+    std::ifstream in(home / "release");
+    if (!in)
+        return std::nullopt;
+
+    Javainstall install;
+    install.home = home.string();
+    bool archfound = false;
+
+    for (std::string line; std::getline(in, line);)
+    {
+        auto equals = line.find('=');
+        if (equals == std::string::npos)
+            continue;
+
+        std::string key = line.substr(0, equals);
+        std::string value = line.substr(equals + 1);
+        value.erase(std::remove(value.begin(), value.end(), '"'), value.end());
+        value.erase(value.find_last_not_of(" \t\r") + 1);
+
+        if (key == "JAVA_VERSION")
+        {
+            install.major = GetReleaseMajor(value);
+        }
+        else if (key == "OS_ARCH")
+        {
+            archfound = true;
+            if (value == "x86_64" || value == "amd64")
+                install.arch = Arch::x64;
+            else if (value == "aarch64" || value == "arm64")
+                install.arch = Arch::arm64;
+            else if (value == "x86" || value == "i386" || value == "i586" || value == "i686")
+                install.arch = Arch::x32;
+            else
+                archfound = false;
+        }
+    }
+
+    if (install.major <= 0 || !archfound)
+        return std::nullopt;
+    return install;
+}
+
+// - must be called with systemmutex held, release files are only read again when they changed since the last scan.
+static std::vector<Javainstall> ScanSystemJavas()
+{
+    const fs::path cachepath = GetRuntimePath() / "system.json";
+    json cache = json::object();
+    {
+        std::ifstream in(cachepath);
+        if (in)
+        {
+            try
+            {
+                cache = json::parse(in);
+            }
+            catch (...) {}
+        }
+        if (!cache.is_object())
+            cache = json::object();
+    }
+
+    #ifdef _WIN32
+    const char* javaname = "java.exe";
+    #else
+    const char* javaname = "java";
+    #endif
+
+    std::vector<Javainstall> installs;
+    json scanned = json::object();
+    std::unordered_set<std::string> seen;
+
+    for (const auto& home : GetSystemJavaHomes())
+    {
+        std::error_code ec;
+        const fs::path canonical = fs::canonical(home, ec);
+        if (ec || !seen.insert(canonical.string()).second || !fs::exists(canonical / "bin" / javaname, ec))
+            continue;
+
+        const auto written = fs::last_write_time(canonical / "release", ec);
+        if (ec)
+            continue;
+        const std::int64_t stamp = static_cast<std::int64_t>(written.time_since_epoch().count());
+
+        const std::string key = canonical.string();
+        json record;
+        if (cache.contains(key) && cache[key].is_object() && cache[key].value("stamp", std::int64_t{0}) == stamp)
+        {
+            record = cache[key];
+        }
+        else
+        {
+            auto install = ParseReleaseFile(canonical);
+            record = {{"stamp", stamp}, {"major", install ? install->major : 0}, {"arch", install ? static_cast<int>(install->arch) : -1}};
+        }
+        scanned[key] = record;
+
+        if (record.value("major", 0) > 0 && record.value("arch", -1) >= 0)
+            installs.push_back({key, record.value("major", 0), static_cast<Arch>(record.value("arch", 0))});
+    }
+
+    if (scanned != cache)
+    {
+        std::error_code ec;
+        fs::create_directories(GetRuntimePath(), ec);
+
+        fs::path temppath = cachepath;
+        temppath += ".part";
+        {
+            std::ofstream out(temppath, std::ios::trunc);
+            out << scanned.dump(4);
+        }
+        fs::rename(temppath, cachepath, ec);
+        if (ec)
+            fs::remove(temppath, ec);
+    }
+    return installs;
+}
+
+// - adoptium names for the platform and image type, false when adoptium has no build for them.
+static bool GetAdoptiumNames(int javaversion, OS os, Arch arch, std::string& osname, std::string& archname, std::string& imagename)
 {
     if (arch != Arch::x64 && arch != Arch::arm64)
     {
         std::cout << "Unsupported architecture.\n";
-        return std::nullopt;
+        return false;
     }
 
-    const char* osStr = nullptr;
     switch (os)
     {
-        case OS::Windows: osStr = "windows";
+        case OS::Windows: osname = "windows";
         break;
-        case OS::Linux: osStr = "linux";
+        case OS::Linux: osname = "linux";
         break;
-        case OS::Macos: osStr = "mac";
+        case OS::Macos: osname = "mac";
         break;
-        default: return std::nullopt;
+        default: return false;
     }
 
     switch (javaversion)
@@ -61,115 +562,294 @@ std::optional<std::string> GetJavaDownloadUrl(int javaversion, OS os, Arch arch)
         case 25:
             break;
         default:
-            return std::nullopt;
+            return false;
     }
-    std::string archStr = (arch == Arch::x64) ? "x64" : "aarch64";
-    return "https://api.adoptium.net/v3/binary/latest/" + std::to_string(javaversion) + "/ga/" + osStr + "/" + archStr + "/jdk/hotspot/normal/eclipse";
+
+    // - jlink needs the jmods of a full jdk, and there is no jre image for 16.
+    imagename = (GetJavaProfile(javaversion) == Javaprofile::Jre && javaversion != 16) ? "jre" : "jdk";
+    archname = (arch == Arch::x64) ? "x64" : "aarch64";
+    return true;
 }
+// - end helpers.
 
-std::optional<std::string> DownloadJava(const std::string& javaurl, const std::string& versionid)
+std::optional<int> GetJavaVersion(const std::string& versionjson)
 {
-    if (javaurl.empty())
+    auto profile = vanilla::GetVersionProfile(versionjson);
+    if (!profile)
+        return 8;
+
+    return GetJavaVersion(*profile);
+}
+
+std::optional<int> GetJavaVersion(const VersionProfile& profile)
+{
+    switch (profile.javaversion)
+    {
+        case 8:
+        case 16:
+        case 17:
+        case 21:
+        case 25:
+            return profile.javaversion;
+        default:
+            return 8;
+    }
+}
+
+std::optional<std::string> GetJavaDownloadUrl(int javaversion, OS os, Arch arch)
+{
+    std::string osname, archname, imagename;
+    if (!GetAdoptiumNames(javaversion, os, arch, osname, archname, imagename))
         return std::nullopt;
 
-    const fs::path basedir = fs::path("runtime") / versionid;
-    const fs::path javadir = basedir / "java";
-    const fs::path archivepath = basedir / "runtime.archive";
-    fs::create_directories(basedir);
+    return "https://api.adoptium.net/v3/binary/latest/" + std::to_string(javaversion) + "/ga/" + osname + "/" + archname + "/" + imagename + "/hotspot/normal/eclipse";
+}
+
+std::optional<Javapackage> GetJavaPackage(int javaversion, OS os, Arch arch)
+{
+    std::string osname, archname, imagename;
+    if (!GetAdoptiumNames(javaversion, os, arch, osname, archname, imagename))
+        return std::nullopt;
 
-    if (fs::exists(javadir) && fs::is_directory(javadir))
-        return javadir.string();
+    // - the resolution is cached on disk, machines sharing the file install the very same build until it expires.
+    const std::string url = "https://api.adoptium.net/v3/assets/latest/" + std::to_string(javaversion) + "/hotspot?architecture=" + archname + "&image_type=" + imagename + "&os=" + osname + "&vendor=eclipse";
+    const std::string filename = std::to_string(javaversion) + "-" + osname + "-" + archname + "-" + imagename + ".json";
+    auto response = GETcached(std::wstring(url.begin(), url.end()), filename, (GetRuntimePath() / "packages").string(), javapackagettl);
+    if (!response)
+        return std::nullopt;
 
-    if (!fs::exists(archivepath) || fs::file_size(archivepath) == 0)
+    try
     {
-        std::wstring wurl(javaurl.begin(), javaurl.end());
-        auto result = GET(wurl, GETmode::DiskOnly, "runtime.archive", basedir.string());
-        if (!result)
+        auto j = json::parse(*response);
+        if (!j.is_array() || j.empty() || !j[0].contains("binary") || !j[0]["binary"].contains("package"))
             return std::nullopt;
-    }
 
-    struct archive* a = archive_read_new();
-    archive_read_support_format_all(a);
-    archive_read_support_filter_all(a);
+        const auto& package = j[0]["binary"]["package"];
+        Javapackage javapackage;
+        javapackage.url = package.value("link", "");
+        javapackage.sha256 = package.value("checksum", "");
+        javapackage.size = package.value("size", std::uint64_t{0});
+        javapackage.release = j[0].value("release_name", "");
+        if (javapackage.url.empty())
+            return std::nullopt;
 
-    if (archive_read_open_filename(a, archivepath.string().c_str(), 10240) != ARCHIVE_OK)
+        return javapackage;
+    }
+    catch (...)
     {
-        archive_read_free(a);
         return std::nullopt;
     }
+}
 
-    fs::path extractedroot;
-    struct archive_entry* entry;
+std::vector<Javainstall> GetSystemJavas()
+{
+    std::lock_guard<std::mutex> lock(systemmutex);
+    if (!systemjavas)
+        systemjavas = ScanSystemJavas();
+    return *systemjavas;
+}
+
+std::optional<std::string> GetJavaRuntime(int javaversion, OS os, Arch arch, const std::string& versionid)
+{
+    const fs::path keydir = GetRuntimePath() / GetRuntimeKey(javaversion, os, arch);
 
-    while (archive_read_next_header(a, &entry) == ARCHIVE_OK)
+    // - any complete release of the same major version will do, the most recently installed one wins.
+    std::error_code ec;
+    fs::path javahome;
+    fs::file_time_type newest;
+    for (const auto& entry : fs::directory_iterator(keydir, ec))
     {
-        const char* pathname = archive_entry_pathname(entry);
-        if (!pathname)
-        {
-            archive_read_data_skip(a);
+        const std::string name = entry.path().filename().string();
+        if (!entry.is_directory() || name.empty() || name[0] == '.' || !GetRuntimeComplete(entry.path()))
             continue;
-        }
-        fs::path entrypath(pathname);
 
-        if (entrypath.is_absolute() || entrypath.string().find("..") != std::string::npos)
+        const auto written = fs::last_write_time(entry.path(), ec);
+        if (javahome.empty() || written > newest)
         {
-            archive_read_data_skip(a);
-            continue;
+            javahome = entry.path();
+            newest = written;
         }
+    }
+
+    // - the reference is kept on the release folder, callers get the java home with bin right below it on every os.
+    if (!javahome.empty())
+    {
+        AddReference(versionid, javahome);
+        return GetRuntimeHome(javahome).string();
+    }
+
+    // - fall back to a runtime the host already has, only an exact major version match is trusted.
+    #ifdef _WIN32
+    const bool hostos = os == OS::Windows;
+    #elif defined(__APPLE__)
+    const bool hostos = os == OS::Macos;
+    #else
+    const bool hostos = os == OS::Linux;
+    #endif
+    if (!systemjava || !hostos)
+        return std::nullopt;
+
+    for (const auto& install : GetSystemJavas())
+    {
+        if (install.major == javaversion && install.arch == arch)
+            return install.home;
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> DownloadJava(const std::string& javaurl, int javaversion, OS os, Arch arch, const std::string& versionid, const std::string& sha256, std::uint64_t size)
+{
+    if (auto javahome = GetJavaRuntime(javaversion, os, arch, versionid))
+        return javahome;
+
+    if (javaurl.empty())
+        return std::nullopt;
+
+    const fs::path keydir = GetRuntimePath() / GetRuntimeKey(javaversion, os, arch);
+    const fs::path stagingdir = keydir / ".staging";
+
+    std::error_code ec;
+    fs::remove_all(stagingdir, ec);
+    fs::create_directories(stagingdir);
 
-        if (extractedroot.empty())
+    // - the download runs on its own thread and feeds libarchive through a bounded buffer, so extraction overlaps the transfer.
+    // - with a known size the archive is fetched in parallel ranges, held in memory until the extractor reaches them.
+    Pipebuffer pipe;
+    Sha256 hash;
+    std::atomic<bool> downloaded{false};
+
+    std::thread downloader([&]()
+    {
+        GETrequest request;
+        request.url = javaurl;
+        request.size = size;
+        downloaded = GETpipe(request, [&](const void* data, size_t size)
         {
-            auto it = entrypath.begin();
-            if (it != entrypath.end())
-                extractedroot = basedir / (*it);
-        }
-        fs::path outpath = basedir / entrypath;
+            hash.Update(data, size);
+            return PushPipe(pipe, data, size);
+        });
+        ClosePipe(pipe, false);
+    });
 
-        if (archive_entry_filetype(entry) == AE_IFDIR)
+    const Javaprofile profile = GetJavaProfile(javaversion);
+    bool extracted = ExtractPipe(pipe, stagingdir, profile);
+
+    // - stop the transfer on a broken archive, otherwise drain the trailing bytes so the whole stream is hashed.
+    if (!extracted)
+    {
+        ClosePipe(pipe, true);
+    }
+    else
+    {
+        const void* data;
+        while (PullPipe(pipe, &data) > 0) {}
+    }
+    downloader.join();
+
+    if (extracted && !downloaded)
+    {
+        std::cout << "Failed to download java runtime.\n";
+        extracted = false;
+    }
+
+    if (extracted && !sha256.empty())
+    {
+        std::string expected = sha256;
+        std::transform(expected.begin(), expected.end(), expected.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (hash.Hexdigest() != expected)
         {
-            fs::create_directories(outpath);
+            std::cout << "Failed to verify java runtime.\n";
+            extracted = false;
         }
-        else
-        {
-            fs::create_directories(outpath.parent_path());
+    }
 
-            std::ofstream out(outpath, std::ios::binary);
-            if (!out)
+    // - the archive holds a single top level folder named after the release, that becomes the runtime.
+    fs::path extractedroot;
+    if (extracted)
+    {
+        for (const auto& entry : fs::directory_iterator(stagingdir, ec))
+        {
+            if (entry.is_directory())
             {
-                archive_read_free(a);
-                return std::nullopt;
+                extractedroot = entry.path();
+                break;
             }
+        }
+    }
 
-            const void* buff;
-            size_t size;
-            la_int64_t offset;
+    if (extractedroot.empty())
+    {
+        fs::remove_all(stagingdir, ec);
+        return std::nullopt;
+    }
 
-            while (true)
-            {
-                int r = archive_read_data_block(a, &buff, &size, &offset);
-                if (r == ARCHIVE_EOF)
-                    break;
-                if (r != ARCHIVE_OK)
-                {
-                    archive_read_free(a);
-                    return std::nullopt;
-                }
-                out.write(static_cast<const char*>(buff), size);
-            }
+    const fs::path javahome = keydir / extractedroot.filename();
+    if (!fs::exists(javahome))
+    {
+        // - a failed trim still leaves a working runtime, just the full jdk.
+        if (profile != Javaprofile::Minimal || !LinkMinimalRuntime(extractedroot, javahome, os))
+        {
+            if (profile == Javaprofile::Minimal)
+                std::cout << "Failed to trim java runtime, keeping the full jdk.\n";
+            fs::rename(extractedroot, javahome, ec);
         }
     }
-    archive_read_free(a);
+    fs::remove_all(stagingdir, ec);
+    if (!GetRuntimeComplete(javahome))
+        return std::nullopt;
+
+    AddReference(versionid, javahome);
+    return GetRuntimeHome(javahome).string();
+}
+
+size_t CollectJavaRuntimes()
+{
+    std::lock_guard<std::mutex> lock(referencemutex);
 
-    if (!extractedroot.empty() && fs::exists(extractedroot))
+    // - references of versions that are no longer installed are dropped first.
+    json references = LoadReferences();
+    std::unordered_set<std::string> referenced;
+    for (auto it = references.begin(); it != references.end();)
     {
-        fs::rename(extractedroot, javadir);
+        if (!it.value().is_string() || !fs::exists(datapath / "versions" / it.key()))
+        {
+            it = references.erase(it);
+            continue;
+        }
+        referenced.insert(it.value().get<std::string>());
+        ++it;
     }
-    else
+    SaveReferences(references);
+
+    size_t removed = 0;
+    std::error_code ec;
+    const fs::path runtimepath = GetRuntimePath();
+    for (const auto& keyentry : fs::directory_iterator(runtimepath, ec))
     {
-        return std::nullopt;
+        if (!keyentry.is_directory() || !GetRuntimeKeyValid(keyentry.path().filename().string()))
+            continue;
+
+        // - a release is only removed when it is a complete runtime, anything else in the store is left alone.
+        std::error_code keyec;
+        for (const auto& entry : fs::directory_iterator(keyentry.path(), keyec))
+        {
+            const std::string runtime = entry.path().lexically_relative(runtimepath).generic_string();
+            const std::string name = entry.path().filename().string();
+            if (!entry.is_directory() || name.empty() || name[0] == '.' || referenced.count(runtime) || !GetRuntimeComplete(entry.path()))
+                continue;
+
+            std::error_code removeec;
+            fs::remove_all(entry.path(), removeec);
+            if (!removeec)
+                ++removed;
+        }
     }
-    fs::remove(archivepath);
-    return javadir.string();
+    return removed;
 }
 
-}
\ No newline at end of file
+std::optional<std::string> DownloadJava(const Javapackage& javapackage, int javaversion, OS os, Arch arch, const std::string& versionid)
+{
+    return DownloadJava(javapackage.url, javaversion, os, arch, versionid, javapackage.sha256, javapackage.size);
+}
+
+}
@@ -0,0 +1,350 @@
+#include "api.hpp"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace mcapi
+{
+
+// - helper defines.
+static constexpr std::uint32_t indexmagic = 0x5849434d; // - "MCIX".
+static constexpr std::uint32_t indexversion = 1;
+static constexpr int indexfields = 5;
+
+struct Indexheader
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint64_t source;
+    std::uint32_t count;
+    std::uint32_t buckets;
+    std::uint32_t blobsize;
+    std::uint32_t reserved;
+};
+
+// - offsets and lengths into the string blob for id, url, sha1, type and releaseTime.
+struct Indexrecord
+{
+    std::uint32_t offsets[indexfields];
+    std::uint32_t lengths[indexfields];
+};
+
+struct Mappedfile
+{
+    const std::uint8_t* data = nullptr;
+    size_t size = 0;
+    #ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+    #endif
+
+    ~Mappedfile()
+    {
+        #ifdef _WIN32
+        if (data)
+            UnmapViewOfFile(data);
+        if (mapping)
+            CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+        #else
+        if (data)
+            munmap(const_cast<std::uint8_t*>(data), size);
+        #endif
+    }
+};
+
+static std::mutex indexmutex;
+static std::unique_ptr<Mappedfile> manifestindex;
+// - end helper defines.
+
+// - helpers.
+static std::uint64_t GetFnvHash(const char* data, size_t size)
+{
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= static_cast<std::uint8_t>(data[i]);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+static std::unique_ptr<Mappedfile> MapFile(const fs::path& path)
+{
+    auto mapped = std::make_unique<Mappedfile>();
+
+    #ifdef _WIN32
+    mapped->file = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (mapped->file == INVALID_HANDLE_VALUE)
+        return nullptr;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(mapped->file, &size) || size.QuadPart == 0)
+        return nullptr;
+
+    mapped->mapping = CreateFileMappingW(mapped->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapped->mapping)
+        return nullptr;
+
+    mapped->data = static_cast<const std::uint8_t*>(MapViewOfFile(mapped->mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!mapped->data)
+        return nullptr;
+    mapped->size = static_cast<size_t>(size.QuadPart);
+    #else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return nullptr;
+
+    mapped->data = static_cast<const std::uint8_t*>(data);
+    mapped->size = static_cast<size_t>(st.st_size);
+    #endif
+
+    return mapped;
+}
+
+static const Indexheader* GetIndexHeader(const Mappedfile& index)
+{
+    return reinterpret_cast<const Indexheader*>(index.data);
+}
+
+static const std::uint32_t* GetIndexBuckets(const Mappedfile& index)
+{
+    return reinterpret_cast<const std::uint32_t*>(index.data + sizeof(Indexheader));
+}
+
+static const Indexrecord* GetIndexRecords(const Mappedfile& index)
+{
+    return reinterpret_cast<const Indexrecord*>(GetIndexBuckets(index) + GetIndexHeader(index)->buckets);
+}
+
+static const char* GetIndexBlob(const Mappedfile& index)
+{
+    return reinterpret_cast<const char*>(GetIndexRecords(index) + GetIndexHeader(index)->count);
+}
+
+// - the index is only trusted when it was built from this exact manifest and its sections add up to the file size.
+static bool GetIndexValid(const Mappedfile& index, std::uint64_t source)
+{
+    if (index.size < sizeof(Indexheader))
+        return false;
+
+    const Indexheader* header = GetIndexHeader(index);
+    if (header->magic != indexmagic || header->version != indexversion || header->source != source)
+        return false;
+
+    if (header->buckets == 0 || (header->buckets & (header->buckets - 1)) != 0)
+        return false;
+
+    const std::uint64_t expected = sizeof(Indexheader) +
+        std::uint64_t{header->buckets} * sizeof(std::uint32_t) +
+        std::uint64_t{header->count} * sizeof(Indexrecord) +
+        header->blobsize;
+    return expected == index.size;
+}
+
+static std::string GetIndexField(const Mappedfile& index, const Indexrecord& record, int field)
+{
+    const std::uint32_t blobsize = GetIndexHeader(index)->blobsize;
+    if (record.offsets[field] > blobsize || record.lengths[field] > blobsize - record.offsets[field])
+        return {};
+
+    return std::string(GetIndexBlob(index) + record.offsets[field], record.lengths[field]);
+}
+
+static Manifestentry GetIndexEntry(const Mappedfile& index, const Indexrecord& record)
+{
+    return {GetIndexField(index, record, 0), GetIndexField(index, record, 1), GetIndexField(index, record, 2), GetIndexField(index, record, 3), GetIndexField(index, record, 4)};
+}
+
+static std::optional<std::vector<Manifestentry>> ParseManifestEntries(const std::string& manifestjson)
+{
+    try
+    {
+        auto j = json::parse(manifestjson);
+        if (!j.contains("versions") || !j["versions"].is_array())
+            return std::nullopt;
+
+        std::vector<Manifestentry> entries;
+        entries.reserve(j["versions"].size());
+        for (const auto& version : j["versions"])
+        {
+            if (!version.contains("id") || !version["id"].is_string())
+                continue;
+
+            entries.push_back({version["id"].get<std::string>(), version.value("url", ""), version.value("sha1", ""), version.value("type", ""), version.value("releaseTime", "")});
+        }
+        return entries;
+    }
+    catch (...)
+    {
+        return std::nullopt;
+    }
+}
+
+static bool WriteManifestIndex(const std::vector<Manifestentry>& entries, std::uint64_t source, const fs::path& indexpath)
+{
+    std::uint32_t buckets = 16;
+    while (buckets < entries.size() * 2)
+        buckets <<= 1;
+
+    std::vector<std::uint32_t> table(buckets, 0);
+    std::vector<Indexrecord> records;
+    std::string blob;
+    records.reserve(entries.size());
+
+    for (const auto& entry : entries)
+    {
+        Indexrecord record{};
+        const std::string* fields[indexfields] = {&entry.id, &entry.url, &entry.sha1, &entry.type, &entry.releasetime};
+        for (int i = 0; i < indexfields; ++i)
+        {
+            record.offsets[i] = static_cast<std::uint32_t>(blob.size());
+            record.lengths[i] = static_cast<std::uint32_t>(fields[i]->size());
+            blob += *fields[i];
+        }
+
+        // - open addressing with linear probing, a bucket holds the record number plus one.
+        std::uint32_t bucket = static_cast<std::uint32_t>(GetFnvHash(entry.id.data(), entry.id.size())) & (buckets - 1);
+        while (table[bucket] != 0)
+            bucket = (bucket + 1) & (buckets - 1);
+
+        records.push_back(record);
+        table[bucket] = static_cast<std::uint32_t>(records.size());
+    }
+
+    Indexheader header{indexmagic, indexversion, source, static_cast<std::uint32_t>(records.size()), buckets, static_cast<std::uint32_t>(blob.size()), 0};
+
+    std::error_code ec;
+    fs::create_directories(indexpath.parent_path(), ec);
+
+    fs::path temppath = indexpath;
+    temppath += ".part";
+    {
+        std::ofstream out(temppath, std::ios::binary | std::ios::trunc);
+        if (!out)
+            return false;
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(std::uint32_t));
+        out.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(Indexrecord));
+        out.write(blob.data(), blob.size());
+        if (!out)
+            return false;
+    }
+
+    fs::rename(temppath, indexpath, ec);
+    if (ec)
+    {
+        fs::remove(temppath, ec);
+        return false;
+    }
+    return true;
+}
+
+// - must be called with indexmutex held, rebuilds the index when the manifest changed.
+static const Mappedfile* GetManifestIndex(const std::string& manifestjson)
+{
+    const std::uint64_t source = GetFnvHash(manifestjson.data(), manifestjson.size());
+    if (manifestindex && GetIndexValid(*manifestindex, source))
+        return manifestindex.get();
+
+    // - release the old mapping first, windows refuses to replace a mapped file.
+    manifestindex.reset();
+
+    const fs::path indexpath = datapath / "version_manifest_v2.idx";
+    manifestindex = MapFile(indexpath);
+    if (manifestindex && GetIndexValid(*manifestindex, source))
+        return manifestindex.get();
+    manifestindex.reset();
+
+    auto entries = ParseManifestEntries(manifestjson);
+    if (!entries || !WriteManifestIndex(*entries, source, indexpath))
+        return nullptr;
+
+    manifestindex = MapFile(indexpath);
+    if (manifestindex && GetIndexValid(*manifestindex, source))
+        return manifestindex.get();
+    manifestindex.reset();
+    return nullptr;
+}
+// - end helpers.
+
+namespace vanilla
+{
+
+std::optional<Manifestentry> GetManifestEntry(const std::string& manifestjson, const std::string& versionid)
+{
+    std::lock_guard<std::mutex> lock(indexmutex);
+
+    const Mappedfile* index = GetManifestIndex(manifestjson);
+    if (!index)
+    {
+        // - no usable index on disk, fall back to scanning the parsed manifest.
+        auto entries = ParseManifestEntries(manifestjson);
+        if (!entries)
+            return std::nullopt;
+
+        for (const auto& entry : *entries)
+        {
+            if (entry.id == versionid)
+                return entry;
+        }
+        return std::nullopt;
+    }
+
+    const Indexheader* header = GetIndexHeader(*index);
+    const std::uint32_t* buckets = GetIndexBuckets(*index);
+    const Indexrecord* records = GetIndexRecords(*index);
+
+    std::uint32_t bucket = static_cast<std::uint32_t>(GetFnvHash(versionid.data(), versionid.size())) & (header->buckets - 1);
+    for (std::uint32_t probe = 0; probe < header->buckets; ++probe)
+    {
+        const std::uint32_t slot = buckets[bucket];
+        if (slot == 0 || slot > header->count)
+            return std::nullopt;
+
+        const Indexrecord& record = records[slot - 1];
+        if (GetIndexField(*index, record, 0) == versionid)
+            return GetIndexEntry(*index, record);
+
+        bucket = (bucket + 1) & (header->buckets - 1);
+    }
+    return std::nullopt;
+}
+
+std::optional<std::vector<Manifestentry>> GetManifestEntries(const std::string& manifestjson)
+{
+    std::lock_guard<std::mutex> lock(indexmutex);
+
+    const Mappedfile* index = GetManifestIndex(manifestjson);
+    if (!index)
+        return ParseManifestEntries(manifestjson);
+
+    const Indexheader* header = GetIndexHeader(*index);
+    const Indexrecord* records = GetIndexRecords(*index);
+
+    std::vector<Manifestentry> entries;
+    entries.reserve(header->count);
+    for (std::uint32_t i = 0; i < header->count; ++i)
+        entries.push_back(GetIndexEntry(*index, records[i]));
+    return entries;
+}
+
+}
+
+}
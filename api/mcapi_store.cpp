@@ -0,0 +1,237 @@
+#include "api.hpp"
+
+namespace mcapi
+{
+
+// - helper defines.
+struct Installedobject
+{
+    std::string sha1;
+    std::uint64_t size = 0;
+    std::int64_t mtime = 0;
+};
+
+static std::mutex installedmutex;
+static std::unordered_map<std::string, Installedobject> installed;
+static bool installedloaded = false;
+static bool installeddirty = false;
+// - end helper defines.
+
+// - helpers.
+static fs::path GetInstalledIndexPath()
+{
+    return datapath / "installed.idx";
+}
+
+static std::string GetInstalledKey(const fs::path& path)
+{
+    return path.lexically_normal().generic_string();
+}
+
+static std::optional<Installedobject> GetInstalledStat(const fs::path& path)
+{
+    std::error_code ec;
+    const auto size = fs::file_size(path, ec);
+    if (ec || size == 0)
+        return std::nullopt;
+
+    const auto mtime = fs::last_write_time(path, ec);
+    if (ec)
+        return std::nullopt;
+
+    Installedobject object;
+    object.size = size;
+    object.mtime = static_cast<std::int64_t>(mtime.time_since_epoch().count());
+    return object;
+}
+
+static std::string GetFileSha1(const fs::path& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return {};
+
+    Sha1 hash;
+    char buffer[65536];
+    while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0)
+        hash.Update(buffer, static_cast<size_t>(file.gcount()));
+
+    if (file.bad())
+        return {};
+    return hash.Hexdigest();
+}
+
+// - must be called with installedmutex held, the whole index is one line per object.
+static void LoadInstalledIndex()
+{
+    if (installedloaded)
+        return;
+    installedloaded = true;
+
+    std::ifstream file(GetInstalledIndexPath(), std::ios::binary);
+    if (!file)
+        return;
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream fields(line);
+        std::string path;
+        Installedobject object;
+        if (!std::getline(fields, path, '\t') || !std::getline(fields, object.sha1, '\t') || !(fields >> object.size >> object.mtime))
+            continue;
+
+        installed[path] = object;
+    }
+}
+// - end helpers.
+
+fs::path GetStorePath(const std::string& sha1)
+{
+    std::string hash = sha1;
+    std::transform(hash.begin(), hash.end(), hash.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (hash.size() < 2)
+        return datapath / "objects" / hash;
+    return datapath / "objects" / hash.substr(0, 2) / hash;
+}
+
+bool LinkFromStore(const std::string& sha1, const fs::path& target)
+{
+    const fs::path object = GetStorePath(sha1);
+
+    std::error_code ec;
+    if (!fs::exists(object, ec))
+        return false;
+
+    if (target.has_parent_path())
+        fs::create_directories(target.parent_path(), ec);
+
+    // - a hardlink costs no space, a copy is the fallback when the store lives on another filesystem.
+    fs::remove(target, ec);
+    fs::create_hard_link(object, target, ec);
+    if (!ec)
+        return true;
+
+    ec.clear();
+    fs::copy_file(object, target, fs::copy_options::overwrite_existing, ec);
+    return !ec;
+}
+
+bool GetObjectInstalled(const fs::path& path, const std::string& sha1, std::uint64_t size)
+{
+    std::string expected = sha1;
+    std::transform(expected.begin(), expected.end(), expected.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    const std::string key = GetInstalledKey(path);
+    {
+        std::lock_guard<std::mutex> lock(installedmutex);
+        LoadInstalledIndex();
+
+        // - an entry is trusted without touching the disk, RescanInstalledIndex is what catches files changed behind our back.
+        // - it only counts for what it was verified against, anything it cannot vouch for is checked on disk again.
+        auto it = installed.find(key);
+        if (it != installed.end())
+        {
+            if (size > 0 && it->second.size != size)
+                return false;
+            if (expected.empty() || it->second.sha1 == expected)
+                return true;
+            if (!it->second.sha1.empty())
+                return false;
+        }
+    }
+
+    // - files from before the index existed are checked against the expected size and hash once, then remembered.
+    // - the hash runs without the lock, so lookups of other objects never queue behind it.
+    auto object = GetInstalledStat(path);
+    if (!object || (size > 0 && object->size != size))
+        return false;
+
+    if (!expected.empty())
+    {
+        if (GetFileSha1(path) != expected)
+            return false;
+        object->sha1 = expected;
+    }
+
+    std::lock_guard<std::mutex> lock(installedmutex);
+    installed[key] = *object;
+    installeddirty = true;
+    return true;
+}
+
+void MarkObjectInstalled(const fs::path& path, const std::string& sha1)
+{
+    std::lock_guard<std::mutex> lock(installedmutex);
+    LoadInstalledIndex();
+
+    auto object = GetInstalledStat(path);
+    if (!object)
+        return;
+
+    object->sha1 = sha1;
+    installed[GetInstalledKey(path)] = *object;
+    installeddirty = true;
+}
+
+bool SaveInstalledIndex()
+{
+    std::lock_guard<std::mutex> lock(installedmutex);
+    if (!installeddirty)
+        return true;
+
+    const fs::path indexpath = GetInstalledIndexPath();
+    fs::path temppath = indexpath;
+    temppath += ".part";
+
+    std::error_code ec;
+    fs::create_directories(indexpath.parent_path(), ec);
+    {
+        std::ofstream file(temppath, std::ios::binary | std::ios::trunc);
+        if (!file)
+            return false;
+
+        for (const auto& [path, object] : installed)
+            file << path << '\t' << object.sha1 << '\t' << object.size << ' ' << object.mtime << '\n';
+        if (!file)
+            return false;
+    }
+
+    fs::rename(temppath, indexpath, ec);
+    if (ec)
+    {
+        fs::remove(temppath, ec);
+        return false;
+    }
+    installeddirty = false;
+    return true;
+}
+
+size_t RescanInstalledIndex()
+{
+    size_t removed = 0;
+    {
+        std::lock_guard<std::mutex> lock(installedmutex);
+        LoadInstalledIndex();
+
+        // - drop every object that is gone or was touched since it was recorded.
+        for (auto it = installed.begin(); it != installed.end();)
+        {
+            auto object = GetInstalledStat(it->first);
+            if (object && object->size == it->second.size && object->mtime == it->second.mtime)
+            {
+                ++it;
+                continue;
+            }
+            it = installed.erase(it);
+            removed++;
+        }
+        if (removed > 0)
+            installeddirty = true;
+    }
+    SaveInstalledIndex();
+    return removed;
+}
+
+}
@@ -48,10 +48,18 @@ bool GetRuleAllow(const json& lib, OS os)
     if (!lib.contains("rules"))
         return true;
 
+    return GetRulesAllow(lib["rules"], os);
+}
+
+bool GetRulesAllow(const json& rules, OS os)
+{
+    if (!rules.is_array())
+        return true;
+
     bool allowed = false;
     const std::string osname = GetOSRuleName(os);
 
-    for (const auto& rule : lib["rules"])
+    for (const auto& rule : rules)
     {
         bool applies = true;
 
@@ -89,108 +97,625 @@ static bool GetVersionAllow(const std::string& versionid)
     return (major > 1) || (major == 1 && minor >= 19);
 }
 
-static std::string GetReplacedArgs(std::string str, const argsmap& vars)
+static Argtemplate GetArgTemplate(const std::string& str)
 {
-    for (const auto& [key, value] : vars)
+    Argtemplate compiled;
+    size_t pos = 0;
+    while (pos < str.size())
     {
-        std::string token = "${" + key + "}";
-        size_t pos;
-        while ((pos = str.find(token)) != std::string::npos)
-            str.replace(pos, token.size(), value);
+        size_t start = str.find("${", pos);
+        size_t end = (start == std::string::npos) ? std::string::npos : str.find('}', start + 2);
+        if (end == std::string::npos)
+        {
+            compiled.segments.push_back({str.substr(pos), false});
+            compiled.literalsize += str.size() - pos;
+            break;
+        }
+
+        if (start > pos)
+        {
+            compiled.segments.push_back({str.substr(pos, start - pos), false});
+            compiled.literalsize += start - pos;
+        }
+        compiled.segments.push_back({str.substr(start + 2, end - start - 2), true});
+        pos = end + 1;
     }
-    return str;
+    return compiled;
+}
+
+static void GetRenderedArgs(const Argtemplate& compiled, const argsmap& vars, std::string& out)
+{
+    for (const auto& segment : compiled.segments)
+    {
+        if (!segment.variable)
+        {
+            out += segment.text;
+            continue;
+        }
+
+        // - unknown variables are kept as they were written.
+        auto it = vars.find(segment.text);
+        if (it != vars.end())
+            out += it->second;
+        else
+            out.append("${").append(segment.text).append("}");
+    }
+}
+
+// - fills in what vars knows and keeps every other variable, so a later render only has those left to do.
+static Argtemplate GetBoundArgs(const Argtemplate& compiled, const argsmap& vars)
+{
+    Argtemplate bound;
+    for (const auto& segment : compiled.segments)
+    {
+        auto it = segment.variable ? vars.find(segment.text) : vars.end();
+        if (segment.variable && it == vars.end())
+        {
+            bound.segments.push_back(segment);
+            continue;
+        }
+
+        const std::string& text = segment.variable ? it->second : segment.text;
+        if (!bound.segments.empty() && !bound.segments.back().variable)
+            bound.segments.back().text += text;
+        else
+            bound.segments.push_back({text, false});
+        bound.literalsize += text.size();
+    }
+    return bound;
+}
+
+static Argtemplate GetLiteralArgs(const std::string& str)
+{
+    return Argtemplate{{{str, false}}, str.size()};
 }
 
-static void GetArgsAppend(const json& node, std::vector<std::string>& out, const argsmap& vars, OS os)
+// - quoting looks at the finished argument, a value with spaces filled in late still stays one argument.
+static void GetQuotedArgs(const std::string& str, std::string& out)
 {
-    if (!GetRuleAllow(node, os)) 
+    if (str.find(' ') != std::string::npos || str.find('"') != std::string::npos)
+        out.append("\"").append(str).append("\"");
+    else
+        out.append(str);
+}
+
+static void GetArgsAppend(const Argument& argument, std::vector<Argtemplate>& out, const argsmap& vars, OS os)
+{
+    if (!GetRulesAllow(argument.rules, os))
         return;
 
-    if (node.is_string()) 
+    for (const auto& value : argument.values)
+        out.push_back(GetBoundArgs(value, vars));
+}
+
+static json GetLaunchTemplateJson(const Launchtemplate& launchtemplate)
+{
+    json arguments = json::array();
+    for (const auto& argument : launchtemplate.arguments)
     {
-        out.push_back(GetReplacedArgs(node.get<std::string>(), vars));
+        json segments = json::array();
+        for (const auto& segment : argument.segments)
+            segments.push_back(json{{"text", segment.text}, {"variable", segment.variable}});
+        arguments.push_back(std::move(segments));
     }
-    else if (node.is_object() && node.contains("value")) 
+    return arguments;
+}
+
+static std::optional<Launchtemplate> GetLaunchTemplateFromJson(const json& node)
+{
+    if (!node.is_array())
+        return std::nullopt;
+
+    Launchtemplate launchtemplate;
+    launchtemplate.arguments.reserve(node.size());
+    for (const auto& segments : node)
     {
-        const auto& value = node["value"];
-        if (value.is_string()) 
+        if (!segments.is_array())
+            return std::nullopt;
+
+        Argtemplate argument;
+        for (const auto& segment : segments)
         {
-            out.push_back(GetReplacedArgs(value.get<std::string>(), vars));
-        } 
-        else if (value.is_array()) 
+            argument.segments.push_back({segment.at("text").get<std::string>(), segment.at("variable").get<bool>()});
+            if (!argument.segments.back().variable)
+                argument.literalsize += argument.segments.back().text.size();
+        }
+        launchtemplate.arguments.push_back(std::move(argument));
+    }
+    return launchtemplate;
+}
+
+static std::optional<Artifact> GetArtifactFromJson(const json& node, const std::string& path)
+{
+    if (!node.is_object() || !node.contains("url") || !node["url"].is_string())
+        return std::nullopt;
+
+    return Artifact{node["url"].get<std::string>(), node.value("path", path), node.value("sha1", ""), node.value("size", std::uint64_t{0})};
+}
+
+// - newer snapshots point these at their own folders, force them onto the natives root.
+static Argtemplate GetJvmArgTemplate(const std::string& value)
+{
+    static const char* overrides[] = {
+        "-Djava.library.path=",
+        "-Djna.tmpdir=",
+        "-Dorg.lwjgl.system.SharedLibraryExtractPath=",
+        "-Dio.netty.native.workdir="
+    };
+
+    for (const char* prefix : overrides)
+    {
+        if (value.rfind(prefix, 0) == 0)
+            return GetArgTemplate(std::string(prefix) + "${natives_directory}");
+    }
+    return GetArgTemplate(value);
+}
+
+static std::vector<Argument> GetArgumentsFromJson(const json& node, bool jvm)
+{
+    std::vector<Argument> arguments;
+    if (!node.is_array())
+        return arguments;
+
+    auto Compile = [jvm](const std::string& value) { return jvm ? GetJvmArgTemplate(value) : GetArgTemplate(value); };
+
+    for (const auto& entry : node)
+    {
+        Argument argument;
+        if (entry.is_string())
         {
-            for (const auto& v : value)
-                out.push_back(GetReplacedArgs(v.get<std::string>(), vars));
+            argument.values.push_back(Compile(entry.get<std::string>()));
         }
+        else if (entry.is_object() && entry.contains("value"))
+        {
+            const auto& value = entry["value"];
+            if (value.is_string())
+            {
+                argument.values.push_back(Compile(value.get<std::string>()));
+            }
+            else if (value.is_array())
+            {
+                for (const auto& v : value)
+                    argument.values.push_back(Compile(v.get<std::string>()));
+            }
+
+            if (entry.contains("rules"))
+                argument.rules = entry["rules"];
+        }
+        else
+        {
+            continue;
+        }
+        arguments.push_back(std::move(argument));
     }
+    return arguments;
 }
-// - end helpers.
 
-namespace vanilla
+// - legacy arguments are split before rendering, so paths with spaces stay one argument.
+static std::vector<Argtemplate> GetLegacyArguments(const std::string& minecraftarguments)
 {
+    std::vector<Argtemplate> arguments;
+    std::istringstream legacy(minecraftarguments);
+    for (std::string token; legacy >> token;)
+        arguments.push_back(GetArgTemplate(token));
+    return arguments;
+}
 
-std::optional<std::string> DownloadVersionManifest()
+static Library GetLibraryFromJson(const json& lib)
 {
-    const fs::path manifestpath = datapath / "version_manifest.json";
-    const fs::path manifestdiskpath = datapath;
+    Library library;
+    library.name = lib.value("name", "");
+    library.url = lib.value("url", "");
+    library.sha1 = lib.value("sha1", "");
+    library.size = lib.value("size", std::uint64_t{0});
+
+    if (lib.contains("rules"))
+        library.rules = lib["rules"];
 
-    if (fs::exists(manifestpath) && fs::file_size(manifestpath) > 0)
+    if (lib.contains("natives") && lib["natives"].is_object())
     {
-        std::ifstream file(manifestpath, std::ios::binary);
-        if (!file)
-            return std::nullopt;
+        for (const auto& [os, classifier] : lib["natives"].items())
+        {
+            if (classifier.is_string())
+                library.natives.emplace(os, classifier.get<std::string>());
+        }
+    }
 
-        std::ostringstream buffer;
-        buffer << file.rdbuf();
-        return buffer.str();
+    if (!lib.contains("downloads"))
+        return library;
+
+    const auto& downloads = lib["downloads"];
+    if (downloads.contains("artifact"))
+        library.artifact = GetArtifactFromJson(downloads["artifact"], "");
+
+    if (downloads.contains("classifiers") && downloads["classifiers"].is_object())
+    {
+        for (const auto& [classifier, node] : downloads["classifiers"].items())
+        {
+            if (auto artifact = GetArtifactFromJson(node, ""))
+                library.classifiers.emplace(classifier, *artifact);
+        }
     }
+    return library;
+}
 
-    return GET(L"https://launchermeta.mojang.com/mc/game/version_manifest.json", GETmode::MemoryAndDisk, "", manifestdiskpath.string()).value_or("");
+// - downloads every missing jar of a version in one concurrent batch, the result keeps the order of the input.
+static std::optional<std::vector<std::string>> DownloadLibraryJars(const std::vector<Artifact>& jars, const std::string& versionid, const std::string& kind)
+{
+    std::vector<std::string> downloaded;
+    std::vector<GETrequest> requests;
+    std::vector<size_t> pending;
+    std::unordered_map<std::string, size_t> queued;
+    std::vector<size_t> jarrequest(jars.size(), SIZE_MAX);
+
+    downloaded.reserve(jars.size());
+    for (size_t i = 0; i < jars.size(); ++i)
+    {
+        const auto& jar = jars[i];
+        fs::path fullpath = datapath / versionid / "libraries" / jar.path;
+        downloaded.push_back(fullpath.string());
+
+        if (GetObjectInstalled(fullpath, jar.sha1, jar.size))
+            continue;
+
+        // - jars with a known hash live once in the shared store and are linked into each version.
+        fs::path target = jar.sha1.empty() ? fullpath : GetStorePath(jar.sha1);
+        if (!jar.sha1.empty() && GetObjectInstalled(target, jar.sha1, jar.size))
+        {
+            pending.push_back(i);
+            continue;
+        }
+
+        auto [it, inserted] = queued.emplace(target.string(), requests.size());
+        if (inserted)
+            requests.push_back({jar.url, target.filename().string(), target.parent_path().string(), jar.sha1, jar.size});
+
+        jarrequest[i] = it->second;
+        pending.push_back(i);
+    }
+
+    auto results = GETmulti(requests);
+
+    // - report every failed jar at once instead of stopping at the first.
+    size_t failed = 0;
+    for (size_t i : pending)
+    {
+        const auto& jar = jars[i];
+        bool ok = (jarrequest[i] == SIZE_MAX) || results[jarrequest[i]];
+        if (ok && jarrequest[i] != SIZE_MAX)
+            MarkObjectInstalled(fs::path(requests[jarrequest[i]].folder) / requests[jarrequest[i]].filename, jar.sha1);
+        if (ok && !jar.sha1.empty())
+            ok = LinkFromStore(jar.sha1, downloaded[i]);
+        if (ok)
+            MarkObjectInstalled(downloaded[i], jar.sha1);
+
+        if (!ok)
+        {
+            std::cout << "Failed to download " << kind << ": " << jar.url << "\n";
+            failed++;
+        }
+    }
+
+    SaveInstalledIndex();
+    if (failed > 0)
+    {
+        std::cout << failed << " of " << jars.size() << " " << kind << " downloads failed.\n";
+        return std::nullopt;
+    }
+    return downloaded;
 }
 
-std::optional<std::vector<std::string>> GetVersionsFromManifest(const std::string& manifestjson)
+static std::optional<Asset> GetAssetRecord(const std::string& hash, std::uint64_t size)
 {
-    try
+    Asset asset;
+    if (size > UINT32_MAX || !GetHexBytes(hash, asset.hash.data(), asset.hash.size()))
+        return std::nullopt;
+
+    asset.size = static_cast<std::uint32_t>(size);
+    return asset;
+}
+
+// - sha1 bytes are already uniformly distributed, the first word is a good enough hash.
+struct Assethash
+{
+    size_t operator()(const std::array<std::uint8_t, 20>& hash) const
     {
-        auto j = json::parse(manifestjson);
-        if (!j.contains("versions") || !j["versions"].is_array())
+        size_t value;
+        std::memcpy(&value, hash.data(), sizeof(value));
+        return value;
+    }
+};
+
+static GETrequest GetAssetRequest(const Asset& asset)
+{
+    const fs::path fullpath = datapath / asset.Path();
+    return {asset.Url(), fullpath.filename().string(), fullpath.parent_path().string(), asset.Hash(), asset.size};
+}
+
+static bool GetAssetPresent(const Asset& asset)
+{
+    return GetObjectInstalled(datapath / asset.Path(), asset.Hash(), asset.size);
+}
+
+#ifdef MCAPI_SIMDJSON
+// - on-demand parse of the asset index, only the hash and size of each object are ever touched.
+static std::optional<std::vector<Asset>> GetAssetsFromSimdjson(const std::string& assetindexjson)
+{
+    static thread_local simdjson::ondemand::parser parser;
+    simdjson::padded_string padded(assetindexjson);
+
+    simdjson::ondemand::document doc;
+    if (parser.iterate(padded).get(doc))
+        return std::nullopt;
+
+    simdjson::ondemand::object objects;
+    if (doc["objects"].get_object().get(objects))
+        return std::nullopt;
+
+    std::vector<Asset> assets;
+    for (auto field : objects)
+    {
+        simdjson::ondemand::object obj;
+        if (field.value().get_object().get(obj))
             return std::nullopt;
 
-        std::vector<std::string> ids;
-        ids.reserve(j["versions"].size());
-        for (const auto& versions : j["versions"])
+        std::string_view hash;
+        if (obj["hash"].get_string().get(hash))
+            continue;
+
+        std::uint64_t size = 0;
+        auto error = obj["size"].get_uint64().get(size);
+        if (error && error != simdjson::NO_SUCH_FIELD)
+            return std::nullopt;
+
+        auto asset = GetAssetRecord(std::string(hash), size);
+        if (!asset)
+            return std::nullopt;
+        assets.push_back(*asset);
+    }
+    return assets;
+}
+
+// - the version json is read in any order and keeps its rules as json, so it goes through the simdjson dom instead of on-demand.
+static std::string GetSimdjsonString(simdjson::dom::element node, const char* key, const std::string& fallback = "")
+{
+    std::string_view value;
+    if (node[key].get_string().get(value))
+        return fallback;
+    return std::string(value);
+}
+
+static std::optional<Artifact> GetArtifactFromSimdjson(simdjson::dom::element node, const std::string& path)
+{
+    std::string_view url;
+    if (!node.is_object() || node["url"].get_string().get(url))
+        return std::nullopt;
+
+    std::uint64_t size = 0;
+    if (node["size"].get_uint64().get(size))
+        size = 0;
+    return Artifact{std::string(url), GetSimdjsonString(node, "path", path), GetSimdjsonString(node, "sha1"), size};
+}
+
+static std::optional<std::vector<Argument>> GetArgumentsFromSimdjson(simdjson::dom::element node, bool jvm)
+{
+    std::vector<Argument> arguments;
+    simdjson::dom::array entries;
+    if (node.get_array().get(entries))
+        return arguments;
+
+    auto Compile = [jvm](std::string_view value) { return jvm ? GetJvmArgTemplate(std::string(value)) : GetArgTemplate(std::string(value)); };
+
+    for (auto entry : entries)
+    {
+        Argument argument;
+        std::string_view text;
+        simdjson::dom::element value;
+        if (!entry.get_string().get(text))
         {
-            if (!versions.contains("id") || !versions["id"].is_string())
-                continue;
+            argument.values.push_back(Compile(text));
+        }
+        else if (entry.is_object() && !entry["value"].get(value))
+        {
+            simdjson::dom::array values;
+            if (!value.get_string().get(text))
+            {
+                argument.values.push_back(Compile(text));
+            }
+            else if (!value.get_array().get(values))
+            {
+                for (auto v : values)
+                {
+                    if (v.get_string().get(text))
+                        return std::nullopt;
+                    argument.values.push_back(Compile(text));
+                }
+            }
+
+            simdjson::dom::element rules;
+            if (!entry["rules"].get(rules))
+                argument.rules = json::parse(simdjson::minify(rules));
+        }
+        else
+        {
+            continue;
+        }
+        arguments.push_back(std::move(argument));
+    }
+    return arguments;
+}
 
-            ids.emplace_back(versions["id"].get<std::string>());
+static Library GetLibraryFromSimdjson(simdjson::dom::element lib)
+{
+    Library library;
+    library.name = GetSimdjsonString(lib, "name");
+    library.url = GetSimdjsonString(lib, "url");
+    library.sha1 = GetSimdjsonString(lib, "sha1");
+    if (lib["size"].get_uint64().get(library.size))
+        library.size = 0;
+
+    simdjson::dom::element rules;
+    if (!lib["rules"].get(rules))
+        library.rules = json::parse(simdjson::minify(rules));
+
+    simdjson::dom::object natives;
+    if (!lib["natives"].get(natives))
+    {
+        for (auto field : natives)
+        {
+            std::string_view classifier;
+            if (!field.value.get_string().get(classifier))
+                library.natives.emplace(std::string(field.key), std::string(classifier));
         }
-        return ids;
     }
-    catch (...)
+
+    simdjson::dom::element downloads;
+    if (lib["downloads"].get(downloads))
+        return library;
+
+    simdjson::dom::element artifact;
+    if (!downloads["artifact"].get(artifact))
+        library.artifact = GetArtifactFromSimdjson(artifact, "");
+
+    simdjson::dom::object classifiers;
+    if (!downloads["classifiers"].get(classifiers))
     {
-        return std::nullopt;
+        for (auto field : classifiers)
+        {
+            if (auto classified = GetArtifactFromSimdjson(field.value, ""))
+                library.classifiers.emplace(std::string(field.key), *classified);
+        }
     }
+    return library;
 }
 
-std::optional<std::string> GetVersionJsonDownloadUrl(const std::string& manifestjson, const std::string& versionid)
+static std::optional<VersionProfile> GetVersionProfileFromSimdjson(const std::string& versionjson)
 {
+    static thread_local simdjson::dom::parser parser;
+
+    simdjson::dom::element j;
+    if (parser.parse(versionjson).get(j) || !j.is_object())
+        return std::nullopt;
+
     try
     {
-        auto j = json::parse(manifestjson);
-        for (const auto& entry : j["versions"])
+        VersionProfile profile;
+        profile.id = GetSimdjsonString(j, "id");
+        profile.type = GetSimdjsonString(j, "type", "release");
+        profile.mainclass = GetSimdjsonString(j, "mainClass");
+        profile.assets = GetSimdjsonString(j, "assets");
+        profile.minecraftarguments = GetSimdjsonString(j, "minecraftArguments");
+        profile.legacyarguments = GetLegacyArguments(profile.minecraftarguments);
+
+        simdjson::dom::element node;
+        if (!j["assetIndex"].get(node))
+            profile.assetindex = GetArtifactFromSimdjson(node, "");
+
+        simdjson::dom::element downloads;
+        if (!j["downloads"].get(downloads))
+        {
+            if (!downloads["client"].get(node))
+                profile.client = GetArtifactFromSimdjson(node, "client.jar");
+            if (!downloads["server"].get(node))
+                profile.server = GetArtifactFromSimdjson(node, "server.jar");
+        }
+
+        simdjson::dom::array libraries;
+        if (!j["libraries"].get(libraries))
+        {
+            profile.libraries.reserve(libraries.size());
+            for (auto lib : libraries)
+            {
+                if (lib.is_object())
+                    profile.libraries.push_back(GetLibraryFromSimdjson(lib));
+            }
+        }
+
+        simdjson::dom::element arguments;
+        if (!j["arguments"].get(arguments))
         {
-            if (entry["id"] == versionid)
-                return entry["url"];
+            profile.modernarguments = true;
+            if (!arguments["jvm"].get(node))
+            {
+                auto jvm = GetArgumentsFromSimdjson(node, true);
+                if (!jvm)
+                    return std::nullopt;
+                profile.jvmarguments = std::move(*jvm);
+            }
+            if (!arguments["game"].get(node))
+            {
+                auto game = GetArgumentsFromSimdjson(node, false);
+                if (!game)
+                    return std::nullopt;
+                profile.gamearguments = std::move(*game);
+            }
         }
+
+        std::int64_t javaversion = 0;
+        if (!j["javaVersion"]["majorVersion"].get_int64().get(javaversion))
+            profile.javaversion = static_cast<int>(javaversion);
+
+        return profile;
     }
     catch (...)
     {
         return std::nullopt;
     }
 }
+#endif
+// - end helpers.
+
+std::string Asset::Hash() const
+{
+    return GetHexString(hash.data(), hash.size());
+}
 
-std::optional<std::string> DownloadVersionJson(const std::string& jsonurl, const std::string& versionid)
+std::string Asset::Url() const
+{
+    const std::string hex = Hash();
+    return "https://resources.download.minecraft.net/" + hex.substr(0, 2) + "/" + hex;
+}
+
+std::string Asset::Path() const
+{
+    const std::string hex = Hash();
+    return "assets/objects/" + hex.substr(0, 2) + "/" + hex;
+}
+
+namespace vanilla
+{
+
+std::optional<std::string> DownloadVersionManifest()
+{
+    const fs::path manifestdiskpath = datapath;
+
+    // - the v2 manifest carries a sha1 for every version json, which lets cached copies be validated.
+    return GETcached(L"https://piston-meta.mojang.com/mc/game/version_manifest_v2.json", "version_manifest_v2.json", manifestdiskpath.string()).value_or("");
+}
+
+std::optional<std::vector<std::string>> GetVersionsFromManifest(const std::string& manifestjson)
+{
+    auto entries = GetManifestEntries(manifestjson);
+    if (!entries)
+        return std::nullopt;
+
+    std::vector<std::string> ids;
+    ids.reserve(entries->size());
+    for (const auto& entry : *entries)
+        ids.push_back(entry.id);
+    return ids;
+}
+
+std::optional<std::string> GetVersionJsonDownloadUrl(const std::string& manifestjson, const std::string& versionid)
+{
+    auto entry = GetManifestEntry(manifestjson, versionid);
+    if (!entry || entry->url.empty())
+        return std::nullopt;
+
+    return entry->url;
+}
+
+std::optional<std::string> DownloadVersionJson(const std::string& jsonurl, const std::string& versionid, const std::string& sha1)
 {
     if (jsonurl.empty())
         return std::nullopt;
@@ -206,25 +731,80 @@ std::optional<std::string> DownloadVersionJson(const std::string& jsonurl, const
 
         std::ostringstream buffer;
         buffer << file.rdbuf();
-        return buffer.str();
+        std::string cached = buffer.str();
+
+        // - without a hash the cached copy is trusted, otherwise only a republished or corrupt json is fetched again.
+        if (sha1.empty())
+            return cached;
+
+        Sha1 hash;
+        hash.Update(cached.data(), cached.size());
+        std::string expected = sha1;
+        std::transform(expected.begin(), expected.end(), expected.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (hash.Hexdigest() == expected)
+            return cached;
     }
 
-    std::wstring wurl(jsonurl.begin(), jsonurl.end());
-    return GET(wurl, GETmode::MemoryAndDisk, versionid + ".json", versionpath.string());
+    return GET(GETrequest{jsonurl, versionid + ".json", versionpath.string(), sha1}, GETmode::MemoryAndDisk);
 }
 
-std::optional<std::string> GetClientJarDownloadUrl(const std::string& versionjson)
+std::optional<VersionProfile> GetVersionProfile(const std::string& versionjson)
 {
+    #ifdef MCAPI_SIMDJSON
+    if (auto profile = GetVersionProfileFromSimdjson(versionjson))
+        return profile;
+    #endif
+
     try
     {
         auto j = json::parse(versionjson);
-        if (!j.contains("downloads") || 
-            !j["downloads"].contains("client") || 
-            !j["downloads"]["client"].contains("url"))
-        {
+        if (!j.is_object())
             return std::nullopt;
+
+        VersionProfile profile;
+        profile.id = j.value("id", "");
+        profile.type = j.value("type", "release");
+        profile.mainclass = j.value("mainClass", "");
+        profile.assets = j.value("assets", "");
+        profile.minecraftarguments = j.value("minecraftArguments", "");
+        profile.legacyarguments = GetLegacyArguments(profile.minecraftarguments);
+
+        if (j.contains("assetIndex"))
+            profile.assetindex = GetArtifactFromJson(j["assetIndex"], "");
+
+        if (j.contains("downloads"))
+        {
+            const auto& downloads = j["downloads"];
+            if (downloads.contains("client"))
+                profile.client = GetArtifactFromJson(downloads["client"], "client.jar");
+            if (downloads.contains("server"))
+                profile.server = GetArtifactFromJson(downloads["server"], "server.jar");
+        }
+
+        if (j.contains("libraries") && j["libraries"].is_array())
+        {
+            profile.libraries.reserve(j["libraries"].size());
+            for (const auto& lib : j["libraries"])
+            {
+                if (lib.is_object())
+                    profile.libraries.push_back(GetLibraryFromJson(lib));
+            }
         }
-        return j["downloads"]["client"]["url"].get<std::string>();
+
+        if (j.contains("arguments"))
+        {
+            const auto& arguments = j["arguments"];
+            profile.modernarguments = true;
+            if (arguments.contains("jvm"))
+                profile.jvmarguments = GetArgumentsFromJson(arguments["jvm"], true);
+            if (arguments.contains("game"))
+                profile.gamearguments = GetArgumentsFromJson(arguments["game"], false);
+        }
+
+        if (j.contains("javaVersion") && j["javaVersion"].contains("majorVersion"))
+            profile.javaversion = j["javaVersion"]["majorVersion"].get<int>();
+
+        return profile;
     }
     catch (...)
     {
@@ -232,156 +812,179 @@ std::optional<std::string> GetClientJarDownloadUrl(const std::string& versionjso
     }
 }
 
+std::optional<std::string> GetClientJarDownloadUrl(const std::string& versionjson)
+{
+    auto profile = GetVersionProfile(versionjson);
+    if (!profile)
+        return std::nullopt;
+
+    return GetClientJarDownloadUrl(*profile);
+}
+
+std::optional<std::string> GetClientJarDownloadUrl(const VersionProfile& profile)
+{
+    if (!profile.client)
+        return std::nullopt;
+
+    return profile.client->url;
+}
+
+std::optional<Artifact> GetClientJarArtifact(const std::string& versionjson)
+{
+    auto profile = GetVersionProfile(versionjson);
+    if (!profile)
+        return std::nullopt;
+
+    return GetClientJarArtifact(*profile);
+}
+
+std::optional<Artifact> GetClientJarArtifact(const VersionProfile& profile)
+{
+    return profile.client;
+}
+
 std::optional<std::string> DownloadClientJar(const std::string& clienturl, const std::string& versionid)
 {
-    if (clienturl.empty())
+    return DownloadClientJar(Artifact{clienturl, "client.jar", "", 0}, versionid);
+}
+
+std::optional<std::string> DownloadClientJar(const Artifact& client, const std::string& versionid)
+{
+    if (client.url.empty())
         return std::nullopt;
 
     const fs::path clientpath = datapath / "versions" / versionid;
     const fs::path jarpath = clientpath / "client.jar";
     
-    if (fs::exists(jarpath) && fs::file_size(jarpath) > 0)
+    // - a jar left behind by an older build or a killed run only counts once it matches the version json.
+    if (GetObjectInstalled(jarpath, client.sha1, client.size))
     {
         return std::string{};
     }
 
-    std::wstring wurl(clienturl.begin(), clienturl.end());
-    return GET(wurl, GETmode::DiskOnly, "client.jar", clientpath.string());
+    auto result = GET(GETrequest{client.url, "client.jar", clientpath.string(), client.sha1, client.size}, GETmode::DiskOnly);
+    if (result)
+    {
+        MarkObjectInstalled(jarpath, client.sha1);
+        SaveInstalledIndex();
+    }
+    return result;
 }
 
 std::optional<std::string> GetAssetIndexJsonDownloadUrl(const std::string& versionjson)
 {
-    try
-    {
-        auto j = json::parse(versionjson);
-        if (!j.contains("assetIndex") || 
-            !j["assetIndex"].contains("url"))
-        {
-            return std::nullopt;
-        }
-        return j["assetIndex"]["url"].get<std::string>();
-    }
-    catch (...)
-    {
+    auto profile = GetVersionProfile(versionjson);
+    if (!profile)
         return std::nullopt;
-    }
+
+    return GetAssetIndexJsonDownloadUrl(*profile);
+}
+
+std::optional<std::string> GetAssetIndexJsonDownloadUrl(const VersionProfile& profile)
+{
+    if (!profile.assetindex)
+        return std::nullopt;
+
+    return profile.assetindex->url;
 }
 
 std::optional<std::string> DownloadAssetIndexJson(const std::string& indexurl, const std::string& versionid)
 {
-    if (indexurl.empty())
+    return DownloadAssetIndexJson(Artifact{indexurl, "", "", 0}, versionid);
+}
+
+std::optional<std::string> DownloadAssetIndexJson(const Artifact& assetindex, [[maybe_unused]] const std::string& versionid)
+{
+    if (assetindex.url.empty())
         return std::nullopt;
     
-    const fs::path indexdir  = datapath / versionid / "assets" / "indexes";
-    const auto slash = indexurl.find_last_of('/');
+    const fs::path indexdir  = datapath / "assets" / "indexes";
+    const auto slash = assetindex.url.find_last_of('/');
     if (slash == std::string::npos)
         return std::nullopt;
 
-    const std::string filename = indexurl.substr(slash + 1);
+    const std::string filename = assetindex.url.substr(slash + 1);
     const fs::path indexpath = indexdir / filename;
 
-    if (fs::exists(indexpath) && fs::file_size(indexpath) > 0)
+    // - a cached index is only used once it matches the hash and size from the version json, like the client jar.
+    if (GetObjectInstalled(indexpath, assetindex.sha1, assetindex.size))
     {
         std::ifstream file(indexpath, std::ios::binary);
-        if (!file)
-            return std::nullopt;
-
         std::ostringstream buffer;
         buffer << file.rdbuf();
-        return buffer.str();
+        if (file && !buffer.str().empty())
+            return buffer.str();
     }
-    
-    std::wstring wurl(indexurl.begin(), indexurl.end());
-    return GET(wurl, GETmode::MemoryAndDisk, filename, indexdir.string());
-}
 
-std::optional<std::vector<std::pair<std::string, std::string>>> GetLibrariesDownloadUrl(const std::string& versionjson, OS os)
-{
-    try
+    auto result = GET(GETrequest{assetindex.url, filename, indexdir.string(), assetindex.sha1, assetindex.size}, GETmode::MemoryAndDisk);
+    if (result)
     {
-        auto j = json::parse(versionjson);
-        if (!j.contains("libraries"))
-            return std::nullopt;
-    
-        std::vector<std::pair<std::string, std::string>> urls;
-        for (const auto& lib : j["libraries"])
-        {
-            if (!GetRuleAllow(lib, os))
-                continue;
-
-            if (!lib.contains("downloads") || !lib["downloads"].contains("artifact"))
-                continue;
-
-            const auto& artifact = lib["downloads"]["artifact"];
-            if (!artifact.contains("url") || !artifact.contains("path"))
-                continue;
-
-            std::string url = artifact["url"];
-            std::string path = artifact["path"];
-
-            if (url.find("natives") != std::string::npos)
-                continue;
-            
-            urls.emplace_back(url, path);
-        }
-        return urls;
+        MarkObjectInstalled(indexpath, assetindex.sha1);
+        SaveInstalledIndex();
     }
-    catch (...)
-    {
+    return result;
+}
+
+std::optional<std::vector<Artifact>> GetLibrariesDownloadUrl(const std::string& versionjson, OS os)
+{
+    auto profile = GetVersionProfile(versionjson);
+    if (!profile)
         return std::nullopt;
-    }
+
+    return GetLibrariesDownloadUrl(*profile, os);
 }
 
-std::optional<std::vector<std::string>> DownloadLibraries(const std::vector<std::pair<std::string, std::string>>& libraries, const std::string& versionid)
+std::optional<std::vector<Artifact>> GetLibrariesDownloadUrl(const VersionProfile& profile, OS os)
 {
-    std::vector<std::string> downloaded;
-    for (const auto& [url, relpath] : libraries)
+    std::vector<Artifact> urls;
+    for (const auto& lib : profile.libraries)
     {
-        fs::path fullpath = datapath / versionid / "libraries" / relpath;
-        fs::create_directories(fullpath.parent_path());
-        if (fs::exists(fullpath) && fs::file_size(fullpath) > 0)
-        {
-            downloaded.push_back(fullpath.string());
+        if (!GetRulesAllow(lib.rules, os))
             continue;
-        }
 
-        std::wstring wurl(url.begin(), url.end());
-        std::string filename = fullpath.filename().string();
-        std::string folder = fullpath.parent_path().string();
+        if (!lib.artifact || lib.artifact->path.empty())
+            continue;
 
-        auto result = GET(wurl, GETmode::DiskOnly, filename, folder);
-        if (!result)
-        {
-            std::cout << "Failed to download library: " << url << "\n";
-            return std::nullopt;
-        }
-        downloaded.push_back(fullpath.string());
+        if (lib.artifact->url.find("natives") != std::string::npos)
+            continue;
+
+        urls.push_back(*lib.artifact);
     }
-    return downloaded;
+    return urls;
+}
+
+std::optional<std::vector<std::string>> DownloadLibraries(const std::vector<Artifact>& libraries, const std::string& versionid)
+{
+    return DownloadLibraryJars(libraries, versionid, "library");
 }
 
-std::optional<std::vector<std::pair<std::string, std::string>>> GetAssetsDownloadUrl(const std::string& assetindexjson)
+std::optional<std::vector<Asset>> GetAssetsDownloadUrl(const std::string& assetindexjson)
 {
+    #ifdef MCAPI_SIMDJSON
+    if (auto assets = GetAssetsFromSimdjson(assetindexjson))
+        return assets;
+    #endif
+
     try
     {
         auto j = json::parse(assetindexjson);
         if (!j.contains("objects"))
             return std::nullopt;
 
-        std::vector<std::pair<std::string, std::string>> urls;
+        std::vector<Asset> assets;
+        assets.reserve(j["objects"].size());
         for (const auto& entry : j["objects"].items())
         {
             const auto& obj = entry.value();
             if (!obj.contains("hash"))
                 continue;
 
-            std::string hash = obj["hash"];
-            std::string firsttwo = hash.substr(0, 2);
-            std::string url = "https://resources.download.minecraft.net/" + firsttwo + "/" + hash;
-            std::string path = "assets/objects/" + firsttwo + "/" + hash;
-            urls.emplace_back(url, path);
+            auto asset = GetAssetRecord(obj["hash"].get<std::string>(), obj.value("size", std::uint64_t{0}));
+            if (!asset)
+                return std::nullopt;
+            assets.push_back(*asset);
         }
-        return urls;
+        return assets;
     }
     catch (...)
     {
@@ -390,138 +993,131 @@ std::optional<std::vector<std::pair<std::string, std::string>>> GetAssetsDownloa
     return std::nullopt;
 }
 
-std::optional<std::vector<std::string>> DownloadAssets(const std::vector<std::pair<std::string, std::string>>& assets, const std::string& versionid)
+Assetplan GetAssetsPlan(const std::vector<Asset>& assets)
 {
-    std::vector<std::string> downloaded;
-    for (const auto& [url, relpath] : assets)
+    Assetplan plan;
+
+    // - several asset names can share one object, only plan it once.
+    std::unordered_set<std::array<std::uint8_t, 20>, Assethash> seen;
+    seen.reserve(assets.size());
+    for (const auto& asset : assets)
     {
-        fs::path fullpath = datapath / versionid / relpath;
-        fs::create_directories(fullpath.parent_path());
-        if (fs::exists(fullpath) && fs::file_size(fullpath) > 0)
-        {
-            downloaded.push_back(fullpath.string());
+        if (!seen.insert(asset.hash).second)
             continue;
-        }
 
-        std::wstring wurl(url.begin(), url.end());
-        std::string filename = fullpath.filename().string();
-        std::string folder = fullpath.parent_path().string();
-
-        auto result = GET(wurl, GETmode::DiskOnly, filename, folder);
-        if (!result)
+        if (GetAssetPresent(asset))
         {
-            std::cout << "Failed to download asset: " << url << "\n";
+            plan.present++;
             continue;
         }
-        downloaded.push_back(fullpath.string());
+        plan.missing.push_back(asset);
+        plan.bytes += asset.size;
     }
-    return downloaded;
+
+    // - largest first, so big sounds start early instead of straggling at the end of the run.
+    std::stable_sort(plan.missing.begin(), plan.missing.end(), [](const Asset& a, const Asset& b) { return a.size > b.size; });
+    return plan;
 }
 
-std::optional<std::vector<std::pair<std::string, std::string>>> GetLibrariesNatives(const std::string& versionid, const std::string& versionjson, OS os, Arch arch)
+std::optional<size_t> DownloadAssets(const Assetplan& plan)
 {
-    try
-    {
-        if (arch != Arch::x64 && arch != Arch::arm64)
+    size_t next = 0;
+    size_t downloaded = 0;
+    GETstream(
+        [&](GETrequest& request)
         {
-            std::cout << "Unsupported architecture.\n";
-            return std::nullopt;
-        }
-        
-        auto j = json::parse(versionjson);
-        if (!j.contains("libraries"))
-            return std::nullopt;
-
-        const bool modern = GetVersionAllow(versionid);
-        if (arch == Arch::arm64 && !modern)
-        {
-            std::cout << "arm64 is only supported for 1.19 and higher versions.\n";
-            return std::nullopt;
-        }
-
-        const std::string ruleos = GetOSRuleName(os);
-        const std::string artos = GetOSNativesUrlName(os);
-        const std::string archsuffix = GetArchSuffix(os, arch);
-
-        std::vector<std::pair<std::string, std::string>> natives;
-        for (const auto& lib : j["libraries"])
+            if (next >= plan.missing.size())
+                return GETnext::Done;
+            request = GetAssetRequest(plan.missing[next++]);
+            return GETnext::Ready;
+        },
+        [&](size_t, const GETrequest& request, bool ok)
         {
-            if (!GetRuleAllow(lib, os))
-                continue;
-
-            if (!lib.contains("downloads"))
-                continue;
-
-            const auto& downloads = lib["downloads"];
-            
-            if (!modern)
+            if (!ok)
             {
-                if (!lib.contains("natives") || !downloads.contains("classifiers"))
-                    continue;
+                std::cout << "Failed to download asset: " << request.url << "\n";
+                return;
+            }
+            MarkObjectInstalled(fs::path(request.folder) / request.filename, request.sha1);
+            downloaded++;
+        });
+    SaveInstalledIndex();
 
-                const auto& nativesmap = lib["natives"];
-                if (!nativesmap.contains(ruleos))
-                    continue;
+    // - a partial install must not pass for a complete one, callers stamp the version on success.
+    if (downloaded != plan.missing.size())
+    {
+        std::cout << plan.missing.size() - downloaded << " of " << plan.missing.size() << " asset downloads failed.\n";
+        return std::nullopt;
+    }
+    return plan.present + downloaded;
+}
 
-                std::string classifier = nativesmap[ruleos].get<std::string>() + archsuffix;
+std::optional<size_t> DownloadAssets(const std::vector<Asset>& assets, [[maybe_unused]] const std::string& versionid)
+{
+    return DownloadAssets(GetAssetsPlan(assets));
+}
 
-                const auto& classifiers = downloads["classifiers"];
-                if (!classifiers.contains(classifier))
-                    continue;
+std::optional<std::vector<Artifact>> GetLibrariesNatives(const std::string& versionid, const std::string& versionjson, OS os, Arch arch)
+{
+    auto profile = GetVersionProfile(versionjson);
+    if (!profile)
+        return std::nullopt;
 
-                const auto& native = classifiers[classifier];
-                natives.emplace_back(native["url"].get<std::string>(), native["path"].get<std::string>());
-            }
-            else
-            {
-                if (!downloads.contains("artifact"))
-                    continue;
-                
-                if (downloads.contains("artifact"))
-                {
-                    const auto& artifact = downloads["artifact"];
-                    std::string path = artifact["path"].get<std::string>();
-                    if (path.find("natives-" + artos) != std::string::npos)
-                    {
-                        natives.emplace_back(artifact["url"].get<std::string>(), path);
-                    }
-                }
-            }
-        }
-        return natives;
+    return GetLibrariesNatives(versionid, *profile, os, arch);
+}
+
+std::optional<std::vector<Artifact>> GetLibrariesNatives(const std::string& versionid, const VersionProfile& profile, OS os, Arch arch)
+{
+    if (arch != Arch::x64 && arch != Arch::arm64)
+    {
+        std::cout << "Unsupported architecture.\n";
+        return std::nullopt;
     }
-    catch (...)
+
+    const bool modern = GetVersionAllow(versionid);
+    if (arch == Arch::arm64 && !modern)
     {
+        std::cout << "arm64 is only supported for 1.19 and higher versions.\n";
         return std::nullopt;
     }
-}
 
-std::optional<std::vector<std::string>> DownloadLibrariesNatives(const std::vector<std::pair<std::string, std::string>>& natives, const std::string& versionid)
-{
-    std::vector<std::string> downloaded;
-    for (const auto& [url, relpath] : natives)
+    const std::string ruleos = GetOSRuleName(os);
+    const std::string artos = GetOSNativesUrlName(os);
+    const std::string archsuffix = GetArchSuffix(os, arch);
+
+    std::vector<Artifact> natives;
+    for (const auto& lib : profile.libraries)
     {
-        fs::path fullpath = datapath / versionid / "libraries" / relpath;
-        fs::create_directories(fullpath.parent_path());
-        if (fs::exists(fullpath) && fs::file_size(fullpath) > 0)
-        {
-            downloaded.push_back(fullpath.string());
+        if (!GetRulesAllow(lib.rules, os))
             continue;
-        }
 
-        std::wstring wurl(url.begin(), url.end());
-        std::string filename = fullpath.filename().string();
-        std::string folder = fullpath.parent_path().string();
+        if (!modern)
+        {
+            auto nativesit = lib.natives.find(ruleos);
+            if (nativesit == lib.natives.end())
+                continue;
+
+            auto classifierit = lib.classifiers.find(nativesit->second + archsuffix);
+            if (classifierit == lib.classifiers.end())
+                continue;
 
-        auto result = GET(wurl, GETmode::DiskOnly, filename, folder);
-        if (!result)
+            natives.push_back(classifierit->second);
+        }
+        else
         {
-            std::cout << "Failed to download native jar: " << url << "\n";
-            return std::nullopt;
+            if (!lib.artifact)
+                continue;
+
+            if (lib.artifact->path.find("natives-" + artos) != std::string::npos)
+                natives.push_back(*lib.artifact);
         }
-        downloaded.push_back(fullpath.string());
     }
-    return downloaded;
+    return natives;
+}
+
+std::optional<std::vector<std::string>> DownloadLibrariesNatives(const std::vector<Artifact>& natives, const std::string& versionid)
+{
+    return DownloadLibraryJars(natives, versionid, "native jar");
 }
 
 std::optional<std::vector<std::string>> ExtractLibrariesNatives(const std::vector<std::string>& nativesjars, const std::string& versionid, OS os)
@@ -604,10 +1200,18 @@ std::optional<std::vector<std::string>> ExtractLibrariesNatives(const std::vecto
 }
 
 std::optional<std::string> GetClassPath(const std::string& versionjson, const std::vector<std::string>& libraries, const std::string& clientjarpath, OS os)
+{
+    auto profile = GetVersionProfile(versionjson);
+    if (!profile)
+        return std::nullopt;
+
+    return GetClassPath(*profile, libraries, clientjarpath, os);
+}
+
+std::optional<std::string> GetClassPath([[maybe_unused]] const VersionProfile& profile, const std::vector<std::string>& libraries, const std::string& clientjarpath, OS os)
 {
     try
     {
-        json j = json::parse(versionjson);
         std::vector<std::string> jars;
         for (const auto& lib : libraries)
         {
@@ -647,32 +1251,46 @@ std::optional<std::string> GetClassPath(const std::string& versionjson, const st
 }
 
 std::optional<std::string> GetLaunchCommand(const std::string& username, const std::string& classpath, const std::string& versionjson, const std::string& versionid, OS os, const std::string& uuid, const std::string& accesstoken, const std::string& usertype)
+{
+    auto profile = GetVersionProfile(versionjson);
+    if (!profile)
+        return std::nullopt;
+
+    return GetLaunchCommand(username, classpath, *profile, versionid, os, uuid, accesstoken, usertype);
+}
+
+std::optional<std::string> GetLaunchCommand(const std::string& username, const std::string& classpath, const VersionProfile& profile, const std::string& versionid, OS os, const std::string& uuid, const std::string& accesstoken, const std::string& usertype)
+{
+    auto launchtemplate = GetLaunchTemplate(classpath, profile, versionid, os);
+    if (!launchtemplate)
+        return std::nullopt;
+
+    return GetLaunchCommandFromTemplate(*launchtemplate, username, uuid, accesstoken, usertype);
+}
+
+// - binds everything but the user specific variables, which stay as variables of their argument.
+std::optional<Launchtemplate> GetLaunchTemplate(const std::string& classpath, const VersionProfile& profile, const std::string& versionid, OS os)
 {
     try
     {
-        json j = json::parse(versionjson);
-        if (!j.contains("mainClass"))
+        if (profile.mainclass.empty())
             return std::nullopt;
 
-        std::string mainClass = j["mainClass"];
+        const std::string& mainClass = profile.mainclass;
 
         std::filesystem::path gamedir = datapath / "versions" / versionid;
-        std::filesystem::path assetsdir = datapath / versionid / "assets";
+        std::filesystem::path assetsdir = datapath / "assets";
         std::filesystem::path nativesdir = datapath / versionid / "natives";
         std::filesystem::create_directories(gamedir);
         std::filesystem::create_directories(nativesdir);
 
         argsmap vars = {
-            {"auth_player_name", username},
             {"version_name", versionid},
             {"game_directory", gamedir.string()},
             {"assets_root", assetsdir.string()},
             {"game_assets", assetsdir.string()},
-            {"assets_index_name", j.value("assets", versionid)},
-            {"auth_uuid", uuid},
-            {"auth_access_token", accesstoken},
-            {"user_type", usertype},
-            {"version_type", j.value("type", "release")},
+            {"assets_index_name", profile.assets.empty() ? versionid : profile.assets},
+            {"version_type", profile.type},
             {"classpath", classpath},
             {"natives_directory", nativesdir.string()},
             {"launcher_name", "mcapi"},
@@ -681,110 +1299,240 @@ std::optional<std::string> GetLaunchCommand(const std::string& username, const s
             {"clientid", "mcapi"}, 
             {"auth_xuid", "0"}
         };
-        std::vector<std::string> jvmargs;
-        std::vector<std::string> gameargs;
+        std::vector<Argtemplate> jvmargs;
+        std::vector<Argtemplate> gameargs;
 
-        // - lambda helpers.
-        auto Getquotes = [](const std::string& str) -> std::string 
-        {
-            if (str.find(' ') != std::string::npos || str.find('"') != std::string::npos)
-                return "\"" + str + "\"";
-            return str;
-        };
-        auto ParseArgs = [](const json& args, std::vector<std::string>& jvm, std::vector<std::string>& game, const argsmap& vars, OS os)
-        {
-            if (args.contains("jvm")) {
-                for (const auto& arguments : args["jvm"])
-                    GetArgsAppend(arguments, jvm, vars, os);
-            }
-            if (args.contains("game")) {
-                for (const auto& arguments : args["game"])
-                    GetArgsAppend(arguments, game, vars, os);
-            }
-        };
-        auto ParseLegacyArgs = [](const std::string& args, const argsmap& vars) -> std::vector<std::string>
+        if (profile.modernarguments)
         {
-            std::string replaced = GetReplacedArgs(args, vars);
-            std::istringstream iss(replaced);
-            return {std::istream_iterator<std::string>{iss}, std::istream_iterator<std::string>{}};
-        };
-        // - end lambda helpers.
-
-        if (j.contains("arguments"))
-        {
-            ParseArgs(j["arguments"], jvmargs, gameargs, vars, os);
+            for (const auto& arguments : profile.jvmarguments)
+                GetArgsAppend(arguments, jvmargs, vars, os);
+            for (const auto& arguments : profile.gamearguments)
+                GetArgsAppend(arguments, gameargs, vars, os);
         }
-        else if (j.contains("minecraftArguments"))
+        else if (!profile.legacyarguments.empty())
         {
-            gameargs = ParseLegacyArgs(j["minecraftArguments"], vars);
-            jvmargs = {"-Xmx2G", "-Xms1G", "-Djava.library.path=" + nativesdir.string(), "-cp", classpath};
+            for (const auto& arguments : profile.legacyarguments)
+                gameargs.push_back(GetBoundArgs(arguments, vars));
+            for (const std::string& arguments : {std::string("-Xmx2G"), std::string("-Xms1G"), "-Djava.library.path=" + nativesdir.string(), std::string("-cp"), classpath})
+                jvmargs.push_back(GetLiteralArgs(arguments));
         }
 
-        // - force natives on the root for newer snapshots.
-        const std::string& natives = vars.at("natives_directory");
-        for (auto& arguments : jvmargs)
-        {
-            if (arguments.rfind("-Djava.library.path=", 0) == 0)
-                arguments = "-Djava.library.path=" + natives;
+        Launchtemplate launchtemplate;
+        launchtemplate.arguments.reserve(jvmargs.size() + gameargs.size() + 1);
+        std::move(jvmargs.begin(), jvmargs.end(), std::back_inserter(launchtemplate.arguments));
+        launchtemplate.arguments.push_back(GetLiteralArgs(mainClass));
+        std::move(gameargs.begin(), gameargs.end(), std::back_inserter(launchtemplate.arguments));
+        return launchtemplate;
+    }
+    catch (...)
+    {
+        return std::nullopt;
+    }
+}
+
+std::string GetLaunchCommandFromTemplate(const Launchtemplate& launchtemplate, const std::string& username, const std::string& uuid, const std::string& accesstoken, const std::string& usertype)
+{
+    argsmap vars = {
+        {"auth_player_name", username},
+        {"auth_uuid", uuid},
+        {"auth_access_token", accesstoken},
+        {"user_type", usertype}
+    };
+
+    size_t length = 0;
+    for (const auto& argument : launchtemplate.arguments)
+        length += argument.literalsize + argument.segments.size() * 16 + 3;
+
+    // - each argument is rendered on its own and quoted once it is complete, filled in values are never searched again.
+    std::string cmd;
+    std::string value;
+    cmd.reserve(length);
+    for (const auto& argument : launchtemplate.arguments)
+    {
+        value.clear();
+        GetRenderedArgs(argument, vars, value);
+        GetQuotedArgs(value, cmd);
+        cmd += ' ';
+    }
+    return cmd;
+}
 
-            else if (arguments.rfind("-Djna.tmpdir=", 0) == 0)
-                arguments = "-Djna.tmpdir=" + natives;
+std::optional<Launchstamp> GetLaunchStamp(const std::string& stampid, OS os, Arch arch, const std::string& jsonsha1)
+{
+    const fs::path stamppath = datapath / "stamps" / (stampid + ".json");
 
-            else if (arguments.rfind("-Dorg.lwjgl.system.SharedLibraryExtractPath=", 0) == 0)
-                arguments = "-Dorg.lwjgl.system.SharedLibraryExtractPath=" + natives;
+    std::ifstream file(stamppath, std::ios::binary);
+    if (!file)
+        return std::nullopt;
 
-            else if (arguments.rfind("-Dio.netty.native.workdir=", 0) == 0)
-                arguments = "-Dio.netty.native.workdir=" + natives;
-        }
+    Launchstamp stamp;
+    try
+    {
+        json j = json::parse(file);
+        // - version 1 stamps held the template as one rendered string.
+        if (j.value("version", 0) != 2 || j.value("os", -1) != static_cast<int>(os) || j.value("arch", -1) != static_cast<int>(arch))
+            return std::nullopt;
 
-        std::ostringstream cmd;
-        for (const auto& arguments : jvmargs) cmd << Getquotes(arguments) << " ";
-        cmd << mainClass << " ";
-        for (const auto& arguments : gameargs) cmd << Getquotes(arguments) << " ";
+        auto launchtemplate = GetLaunchTemplateFromJson(j.at("launchtemplate"));
+        if (!launchtemplate)
+            return std::nullopt;
 
-        return cmd.str();
+        stamp.javapath = j.at("javapath").get<std::string>();
+        stamp.nativesdir = j.at("nativesdir").get<std::string>();
+        stamp.classpath = j.at("classpath").get<std::string>();
+        stamp.launchtemplate = std::move(*launchtemplate);
+        stamp.jsonpath = j.at("jsonpath").get<std::string>();
+        stamp.jsonsha1 = j.at("jsonsha1").get<std::string>();
+        stamp.sourcesha1 = j.value("sourcesha1", "");
+        stamp.clientjar = j.at("clientjar").get<std::string>();
+        stamp.os = os;
+        stamp.arch = arch;
     }
     catch (...)
     {
         return std::nullopt;
     }
+
+    // - a version json republished upstream no longer matches the one the stamp was built from.
+    // - stamps from before sourcesha1 was kept were built straight from the manifest json, so its hash stands in.
+    std::string expected = jsonsha1;
+    std::transform(expected.begin(), expected.end(), expected.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    const std::string& source = stamp.sourcesha1.empty() ? stamp.jsonsha1 : stamp.sourcesha1;
+    if (!expected.empty() && expected != source)
+        return std::nullopt;
+
+    // - only a handful of checks, the point of the stamp is to skip walking every installed file.
+    std::error_code ec;
+    if (!fs::exists(stamp.javapath, ec) || !fs::exists(stamp.clientjar, ec) || !fs::exists(stamp.nativesdir, ec))
+        return std::nullopt;
+
+    std::ifstream versionfile(stamp.jsonpath, std::ios::binary);
+    if (!versionfile)
+        return std::nullopt;
+
+    std::ostringstream buffer;
+    buffer << versionfile.rdbuf();
+    const std::string versionjson = buffer.str();
+
+    Sha1 hash;
+    hash.Update(versionjson.data(), versionjson.size());
+    if (hash.Hexdigest() != stamp.jsonsha1)
+        return std::nullopt;
+
+    return stamp;
 }
 
-std::optional<std::string> GetServerJarDownloadUrl(const std::string& versionjson)
+bool SaveLaunchStamp(const std::string& stampid, Launchstamp stamp)
 {
-    try
+    std::ifstream versionfile(stamp.jsonpath, std::ios::binary);
+    if (!versionfile)
+        return false;
+
+    std::ostringstream buffer;
+    buffer << versionfile.rdbuf();
+    const std::string versionjson = buffer.str();
+
+    Sha1 hash;
+    hash.Update(versionjson.data(), versionjson.size());
+    stamp.jsonsha1 = hash.Hexdigest();
+    std::transform(stamp.sourcesha1.begin(), stamp.sourcesha1.end(), stamp.sourcesha1.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    json j = {
+        {"version", 2},
+        {"os", static_cast<int>(stamp.os)},
+        {"arch", static_cast<int>(stamp.arch)},
+        {"javapath", stamp.javapath},
+        {"nativesdir", stamp.nativesdir},
+        {"classpath", stamp.classpath},
+        {"launchtemplate", GetLaunchTemplateJson(stamp.launchtemplate)},
+        {"jsonpath", stamp.jsonpath},
+        {"jsonsha1", stamp.jsonsha1},
+        {"sourcesha1", stamp.sourcesha1},
+        {"clientjar", stamp.clientjar}
+    };
+
+    const fs::path stampdir = datapath / "stamps";
+    const fs::path stamppath = stampdir / (stampid + ".json");
+    fs::path temppath = stamppath;
+    temppath += ".part";
+
+    std::error_code ec;
+    fs::create_directories(stampdir, ec);
     {
-        auto j = json::parse(versionjson);
-        if (!j.contains("downloads") || 
-            !j["downloads"].contains("server") || 
-            !j["downloads"]["server"].contains("url"))
-        {
-            return std::nullopt;
-        }
-        return j["downloads"]["server"]["url"].get<std::string>();
+        std::ofstream file(temppath, std::ios::binary | std::ios::trunc);
+        if (!file)
+            return false;
+        file << j.dump(4);
+        if (!file)
+            return false;
     }
-    catch (...)
+
+    fs::rename(temppath, stamppath, ec);
+    if (ec)
     {
-        return std::nullopt;
+        fs::remove(temppath, ec);
+        return false;
     }
+    return true;
+}
+
+std::optional<std::string> GetServerJarDownloadUrl(const std::string& versionjson)
+{
+    auto profile = GetVersionProfile(versionjson);
+    if (!profile)
+        return std::nullopt;
+
+    return GetServerJarDownloadUrl(*profile);
+}
+
+std::optional<std::string> GetServerJarDownloadUrl(const VersionProfile& profile)
+{
+    if (!profile.server)
+        return std::nullopt;
+
+    return profile.server->url;
+}
+
+std::optional<Artifact> GetServerJarArtifact(const std::string& versionjson)
+{
+    auto profile = GetVersionProfile(versionjson);
+    if (!profile)
+        return std::nullopt;
+
+    return GetServerJarArtifact(*profile);
+}
+
+std::optional<Artifact> GetServerJarArtifact(const VersionProfile& profile)
+{
+    return profile.server;
 }
 
 std::optional<std::string> DownloadServerJar(const std::string& serverurl, const std::string& versionid)
 {
-    if (serverurl.empty())
+    return DownloadServerJar(Artifact{serverurl, "server.jar", "", 0}, versionid);
+}
+
+std::optional<std::string> DownloadServerJar(const Artifact& server, const std::string& versionid)
+{
+    if (server.url.empty())
         return std::nullopt;
 
     const fs::path serverdir = datapath / "versions" / versionid / "server";
     const fs::path jarpath   = serverdir / "server.jar";
 
-    if (fs::exists(jarpath) && fs::file_size(jarpath) > 0)
+    if (GetObjectInstalled(jarpath, server.sha1, server.size))
     {
         return jarpath.string();
     }
     fs::create_directories(serverdir);
 
-    std::wstring wurl(serverurl.begin(), serverurl.end());
-    return GET(wurl, GETmode::DiskOnly, "server.jar", serverdir.string());
+    auto result = GET(GETrequest{server.url, "server.jar", serverdir.string(), server.sha1, server.size}, GETmode::DiskOnly);
+    if (result)
+    {
+        MarkObjectInstalled(jarpath, server.sha1);
+        SaveInstalledIndex();
+    }
+    return result;
 }
 
 }
@@ -203,6 +203,32 @@ void gui::GetVersions()
 
 bool gui::StartVersion(const QString &username, const QString &loaderselected, const QString &versionselected, const QString &archselected, const QString &osselected)
 {
+    // - conversion.
+    mcapi::OS osenum;
+    if (osselected == "windows")
+        osenum = mcapi::OS::Windows;
+    else if (osselected == "linux")
+        osenum = mcapi::OS::Linux;
+    else if (osselected == "macos")
+        osenum = mcapi::OS::Macos;
+    else
+    {
+        qDebug() << "Invalid OS.";
+        return false;
+    }
+    mcapi::Arch archenum;
+    if (archselected == "x64")
+        archenum = mcapi::Arch::x64;
+    else if (archselected == "x32")
+        archenum = mcapi::Arch::x32;
+    else if (archselected == "arm64")
+        archenum = mcapi::Arch::arm64;
+    else
+    {
+        qDebug() << "Invalid architecture.";
+        return false;
+    }
+
     if (loaderselected == "vanilla")
     {
         // - download manifest.
@@ -215,16 +241,24 @@ bool gui::StartVersion(const QString &username, const QString &loaderselected, c
         auto manifest = *manifestopt;
         
         // - download version json.
-        auto versionjsonurl = mcapi::vanilla::GetVersionJsonDownloadUrl(manifest, versionselected.toStdString());
-        if (!versionjsonurl)
+        auto versionentryopt = mcapi::vanilla::GetManifestEntry(manifest, versionselected.toStdString());
+        if (!versionentryopt || versionentryopt->url.empty())
         {
             qDebug() << "Version not found in manifest.";
             return false;
         }
-        auto versionurl = *versionjsonurl;
+        auto versionentry = *versionentryopt;
+
+        // - a launch stamp for this exact version json means everything is installed, a republished json is installed again.
+        const std::string stampid = "vanilla-" + versionselected.toStdString();
+        if (auto stamp = mcapi::vanilla::GetLaunchStamp(stampid, osenum, archenum, versionentry.sha1))
+        {
+            qDebug() << "Launch stamp found, skipping install.";
+            return LaunchStamp(*stamp, username, osenum);
+        }
 
         qDebug() << "Downloading version json...";
-        auto versionjsonopt = mcapi::vanilla::DownloadVersionJson(versionurl, versionselected.toStdString());
+        auto versionjsonopt = mcapi::vanilla::DownloadVersionJson(versionentry.url, versionselected.toStdString(), versionentry.sha1);
         if (!versionjsonopt)
         {
             qDebug() << "Failed to download version json (are you offline?).";
@@ -233,17 +267,25 @@ bool gui::StartVersion(const QString &username, const QString &loaderselected, c
         qDebug() << "Version json downloaded.";
         auto versionjson = *versionjsonopt;
 
+        auto profileopt = mcapi::vanilla::GetVersionProfile(versionjson);
+        if (!profileopt)
+        {
+            qDebug() << "Failed to parse version json.";
+            return false;
+        }
+        const auto& profile = *profileopt;
+
         // - download client jar.
-        auto jarurlopt = mcapi::vanilla::GetClientJarDownloadUrl(versionjson);
-        if (!jarurlopt)
+        auto jaropt = mcapi::vanilla::GetClientJarArtifact(profile);
+        if (!jaropt)
         {
             qDebug() << "Failed to get client jar url.";
             return false;
         }
-        auto jarurl = *jarurlopt;
+        auto jar = *jaropt;
 
         qDebug() << "Downloading client jar...";
-        auto clientjar = mcapi::vanilla::DownloadClientJar(jarurl, versionselected.toStdString());
+        auto clientjar = mcapi::vanilla::DownloadClientJar(jar, versionselected.toStdString());
         if (!clientjar)
         {
             qDebug() << "Failed to download client jar.";
@@ -252,16 +294,15 @@ bool gui::StartVersion(const QString &username, const QString &loaderselected, c
         qDebug() << "Client jar downloaded.";
 
         // - download asset index.
-        auto indexurlopt = mcapi::vanilla::GetAssetIndexJsonDownloadUrl(versionjson);
-        if (!indexurlopt)
+        if (!profile.assetindex)
         {
             qDebug() << "Failed to get asset index URL.";
             return false;
         }
-        auto indexurl = *indexurlopt;
+        auto assetindex = *profile.assetindex;
 
         qDebug() << "Downloading Asset index...";
-        auto assetjsonopt = mcapi::vanilla::DownloadAssetIndexJson(indexurl, versionselected.toStdString());
+        auto assetjsonopt = mcapi::vanilla::DownloadAssetIndexJson(assetindex, versionselected.toStdString());
         if (!assetjsonopt)
         {
             qDebug() << "Failed to download asset index.";
@@ -270,16 +311,18 @@ bool gui::StartVersion(const QString &username, const QString &loaderselected, c
         auto assetjson = *assetjsonopt;
         qDebug() << "Asset index downloaded.";
 
-        // - download assets.
+        // - plan assets.
         auto assetsurlopt = mcapi::vanilla::GetAssetsDownloadUrl(assetjson);
         if (!assetsurlopt)
         {
             qDebug() << "Failed to get assets download urls.";
             return false;
         }
+        auto assetsplan = mcapi::vanilla::GetAssetsPlan(*assetsurlopt);
 
-        qDebug() << "Downloading assets... (this may take a while)";
-        auto assets = mcapi::vanilla::DownloadAssets(*assetsurlopt, versionselected.toStdString());
+        // - download assets.
+        qDebug() << "Downloading" << assetsplan.missing.size() << "assets," << assetsplan.bytes / (1024 * 1024) << "MB... (this may take a while)";
+        auto assets = mcapi::vanilla::DownloadAssets(assetsplan);
         if (!assets)
         {
             qDebug() << "Failed to download assets.";
@@ -287,34 +330,8 @@ bool gui::StartVersion(const QString &username, const QString &loaderselected, c
         }
         qDebug() << "Assets downloaded.";
 
-        // - conversion.
-        mcapi::OS osenum;
-        if (osselected == "windows")
-            osenum = mcapi::OS::Windows;
-        else if (osselected == "linux")
-            osenum = mcapi::OS::Linux;
-        else if (osselected == "macos")
-            osenum = mcapi::OS::Macos;
-        else
-        {
-            qDebug() << "Invalid OS.";
-            return false;
-        }
-        mcapi::Arch archenum;
-        if (archselected == "x64")
-            archenum = mcapi::Arch::x64;
-        else if (archselected == "x32")
-            archenum = mcapi::Arch::x32;
-        else if (archselected == "arm64")
-            archenum = mcapi::Arch::arm64;
-        else
-        {
-            qDebug() << "Invalid architecture.";
-            return false;
-        }
-
         // - download java.
-        auto javaversionopt = mcapi::GetJavaVersion(versionjson);
+        auto javaversionopt = mcapi::GetJavaVersion(profile);
         if (!javaversionopt)
         {
             qDebug() << "Failed to get java version.";
@@ -322,26 +339,41 @@ bool gui::StartVersion(const QString &username, const QString &loaderselected, c
         }
         int javaversion = *javaversionopt;
 
-        auto javaurlopt = mcapi::GetJavaDownloadUrl(javaversion, osenum, archenum);
-        if (!javaurlopt)
-        {
-            qDebug() << "Failed to get java download url.";
-            return false;
-        }
-        auto javaurl = *javaurlopt;
-
-         qDebug() << "Downloading java...";
-        auto javaopt = mcapi::DownloadJava(javaurl, versionselected.toStdString());
+        // - versions needing the same major release share one runtime, only download when none is installed yet.
+        auto javaopt = mcapi::GetJavaRuntime(javaversion, osenum, archenum, versionselected.toStdString());
         if (!javaopt)
         {
-            qDebug() << "Failed to download java.";
-            return false;
+            auto javapackageopt = mcapi::GetJavaPackage(javaversion, osenum, archenum);
+            if (javapackageopt)
+            {
+                qDebug() << "Downloading java" << QString::fromStdString(javapackageopt->release) << "...";
+                javaopt = mcapi::DownloadJava(*javapackageopt, javaversion, osenum, archenum, versionselected.toStdString());
+            }
+            else
+            {
+                // - the assets api did not answer, fall back to the unpinned latest build.
+                auto javaurlopt = mcapi::GetJavaDownloadUrl(javaversion, osenum, archenum);
+                if (!javaurlopt)
+                {
+                    qDebug() << "Failed to get java download url.";
+                    return false;
+                }
+
+                qDebug() << "Downloading java...";
+                javaopt = mcapi::DownloadJava(*javaurlopt, javaversion, osenum, archenum, versionselected.toStdString());
+            }
+
+            if (!javaopt)
+            {
+                qDebug() << "Failed to download java.";
+                return false;
+            }
+            qDebug() << "Java downloaded.";
         }
-        qDebug() << "Java downloaded.";
         auto java = *javaopt;
 
         // - download libraries.
-        auto librariesurlopt = mcapi::vanilla::GetLibrariesDownloadUrl(versionjson, osenum);
+        auto librariesurlopt = mcapi::vanilla::GetLibrariesDownloadUrl(profile, osenum);
         if (!librariesurlopt)
         {
             qDebug() << "Failed to get libraries.";
@@ -359,7 +391,7 @@ bool gui::StartVersion(const QString &username, const QString &loaderselected, c
 
         // - extract natives.
         qDebug() << "Extracting natives...";
-        auto nativesurlopt = mcapi::vanilla::GetLibrariesNatives(versionselected.toStdString(), versionjson, osenum, archenum);
+        auto nativesurlopt = mcapi::vanilla::GetLibrariesNatives(versionselected.toStdString(), profile, osenum, archenum);
         if (!nativesurlopt)
         {
             qDebug() << "Failed to get natives urls.";
@@ -385,7 +417,7 @@ bool gui::StartVersion(const QString &username, const QString &loaderselected, c
         // - build classpath.
         qDebug() << "Building classpath...";
         fs::path datapath = ".mcapi";
-        auto classpathopt = mcapi::vanilla::GetClassPath(versionjson, *librariesdownloaded, (datapath / "versions" / versionselected.toStdString() / "client.jar").string(), osenum);
+        auto classpathopt = mcapi::vanilla::GetClassPath(profile, *librariesdownloaded, (datapath / "versions" / versionselected.toStdString() / "client.jar").string(), osenum);
         if (!classpathopt)
         {
             qDebug() << "Failed to build classpath.";
@@ -394,57 +426,56 @@ bool gui::StartVersion(const QString &username, const QString &loaderselected, c
         auto classpath = *classpathopt;
         qDebug() << "Classpath built.";
 
-        // - build launch command depending on whether the user is offline or logged in.
-        std::string launchcmd;
-        if (microsoft)
+        // - build the launch template once, then fill in whether the user is offline or logged in.
+        qDebug() << "Building launch command...";
+        auto launchtemplateopt = mcapi::vanilla::GetLaunchTemplate(classpath, profile, versionselected.toStdString(), osenum);
+        if (!launchtemplateopt)
         {
-            qDebug() << "Building launch command...";
-            auto launchcmdopt = mcapi::vanilla::GetLaunchCommand(microsoftusername, classpath, versionjson, versionselected.toStdString(), osenum, microsoftuuid, microsoftaccesstoken, "msa");
-            if (!launchcmdopt)
-            {
-                qDebug() << "Failed to build launch command.";
-                return false;
-            }
-            launchcmd = *launchcmdopt;
-            qDebug() << "Launch command built.";
+            qDebug() << "Failed to build launch command.";
+            return false;
         }
+        auto launchtemplate = *launchtemplateopt;
+
+        std::string launchcmd;
+        if (microsoft)
+            launchcmd = mcapi::vanilla::GetLaunchCommandFromTemplate(launchtemplate, microsoftusername, microsoftuuid, microsoftaccesstoken, "msa");
         else
-        {
-            qDebug() << "Building launch command...";
-            auto launchcmdopt = mcapi::vanilla::GetLaunchCommand(username.toStdString(), classpath, versionjson, versionselected.toStdString(), osenum);
-            if (!launchcmdopt)
-            {
-                qDebug() << "Failed to build launch command.";
-                return false;
-            }
-            launchcmd = *launchcmdopt;
-            qDebug() << "Launch command built.";
-        }
+            launchcmd = mcapi::vanilla::GetLaunchCommandFromTemplate(launchtemplate, username.toStdString());
+        qDebug() << "Launch command built.";
 
         // - launch minecraft.
         std::string javapath;
         switch (osenum)
         {
         case mcapi::OS::Windows:
-            javapath = "runtime/" + versionselected.toStdString() + "/java/bin/java.exe";
+            javapath = (fs::path(java) / "bin" / "java.exe").string();
             break;
 
         case mcapi::OS::Linux:
         case mcapi::OS::Macos:
-            javapath = "runtime/" + versionselected.toStdString() + "/java/bin/java";
+            javapath = (fs::path(java) / "bin" / "java").string();
             break;
         }
-        bool launched = mcapi::StartProcess(javapath, launchcmd, osenum, &process, true);
-        if (!launched)
-        {
-            QMetaObject::invokeMethod(this, [this](){QMessageBox::critical(this, "error", "Failed to launch minecraft.");}, Qt::QueuedConnection);
-            return false;
-        }
-        else
-        {
-            QMetaObject::invokeMethod(this, [this](){QMessageBox::information(this, "info", "Minecraft launched.");}, Qt::QueuedConnection);
-            return true;
-        }
+
+        // - remember the resolved launch so the next start can skip the pipeline.
+        mcapi::Launchstamp stamp;
+        stamp.javapath = javapath;
+        stamp.nativesdir = (datapath / versionselected.toStdString() / "natives").string();
+        stamp.classpath = classpath;
+        stamp.launchtemplate = launchtemplate;
+        stamp.jsonpath = (datapath / "versions" / versionselected.toStdString() / (versionselected.toStdString() + ".json")).string();
+        stamp.sourcesha1 = versionentry.sha1;
+        stamp.clientjar = (datapath / "versions" / versionselected.toStdString() / "client.jar").string();
+        stamp.os = osenum;
+        stamp.arch = archenum;
+        if (!mcapi::vanilla::SaveLaunchStamp(stampid, stamp))
+            qDebug() << "Failed to save launch stamp.";
+
+        // - runtimes no installed version points at anymore are dropped.
+        if (size_t removed = mcapi::CollectJavaRuntimes())
+            qDebug() << "Removed" << removed << "unused java runtimes.";
+
+        return LaunchVersion(javapath, launchcmd, osenum);
     }
     else if (loaderselected == "fabric")
     {
@@ -480,6 +511,29 @@ bool gui::StartVersion(const QString &username, const QString &loaderselected, c
 
         QString versionid = versionselected + "-fabric-loader-" + QString::fromStdString(loader);
 
+        // - the parent version json is checked against the manifest like vanilla, a republished parent installs again.
+        auto manifestopt = mcapi::vanilla::DownloadVersionManifest();
+        if (!manifestopt)
+        {
+            qDebug() << "Failed to download manifest.";
+            return false;
+        }
+        auto parententryopt = mcapi::vanilla::GetManifestEntry(*manifestopt, versionselected.toStdString());
+        if (!parententryopt || parententryopt->url.empty())
+        {
+            qDebug() << "Version not found in manifest.";
+            return false;
+        }
+        auto parententry = *parententryopt;
+
+        // - stamps are keyed by the resolved loader, a newer loader installs again.
+        const std::string stampid = "fabric-" + versionid.toStdString();
+        if (auto stamp = mcapi::vanilla::GetLaunchStamp(stampid, osenum, archenum, parententry.sha1))
+        {
+            qDebug() << "Launch stamp found, skipping install.";
+            return LaunchStamp(*stamp, username, osenum);
+        }
+
         // - download fabric version json.
         auto versionjsonurl = mcapi::fabric::GetLoaderJsonDownloadUrl(loader, versionselected.toStdString());
         if (!versionjsonurl)
@@ -509,17 +563,25 @@ bool gui::StartVersion(const QString &username, const QString &loaderselected, c
         }
         auto mergedjson = *mergedjsonopt;
 
+        auto profileopt = mcapi::vanilla::GetVersionProfile(mergedjson);
+        if (!profileopt)
+        {
+            qDebug() << "Failed to parse merged version json.";
+            return false;
+        }
+        const auto& profile = *profileopt;
+
         // - download client jar.
-        auto jarurlopt = mcapi::vanilla::GetClientJarDownloadUrl(mergedjson);
-        if (!jarurlopt)
+        auto jaropt = mcapi::vanilla::GetClientJarArtifact(profile);
+        if (!jaropt)
         {
             qDebug() << "Failed to get client jar url.";
             return false;
         }
-        auto jarurl = *jarurlopt;
+        auto jar = *jaropt;
 
         qDebug() << "Downloading client jar...";
-        auto clientjar = mcapi::vanilla::DownloadClientJar(jarurl, versionid.toStdString());
+        auto clientjar = mcapi::vanilla::DownloadClientJar(jar, versionid.toStdString());
         if (!clientjar)
         {
             qDebug() << "Failed to download client jar.";
@@ -528,16 +590,15 @@ bool gui::StartVersion(const QString &username, const QString &loaderselected, c
         qDebug() << "Client jar downloaded.";
 
         // - download asset index.
-        auto indexurlopt = mcapi::vanilla::GetAssetIndexJsonDownloadUrl(mergedjson);
-        if (!indexurlopt)
+        if (!profile.assetindex)
         {
             qDebug() << "Failed to get asset index URL.";
             return false;
         }
-        auto indexurl = *indexurlopt;
+        auto assetindex = *profile.assetindex;
 
         qDebug() << "Downloading Asset index...";
-        auto assetjsonopt = mcapi::vanilla::DownloadAssetIndexJson(indexurl, versionid.toStdString());
+        auto assetjsonopt = mcapi::vanilla::DownloadAssetIndexJson(assetindex, versionid.toStdString());
         if (!assetjsonopt)
         {
             qDebug() << "Failed to download asset index.";
@@ -546,16 +607,18 @@ bool gui::StartVersion(const QString &username, const QString &loaderselected, c
         auto assetjson = *assetjsonopt;
         qDebug() << "Asset index downloaded.";
 
-        // - download assets.
+        // - plan assets.
         auto assetsurlopt = mcapi::vanilla::GetAssetsDownloadUrl(assetjson);
         if (!assetsurlopt)
         {
             qDebug() << "Failed to get assets download urls.";
             return false;
         }
+        auto assetsplan = mcapi::vanilla::GetAssetsPlan(*assetsurlopt);
 
-        qDebug() << "Downloading assets... (this may take a while)";
-        auto assets = mcapi::vanilla::DownloadAssets(*assetsurlopt, versionid.toStdString());
+        // - download assets.
+        qDebug() << "Downloading" << assetsplan.missing.size() << "assets," << assetsplan.bytes / (1024 * 1024) << "MB... (this may take a while)";
+        auto assets = mcapi::vanilla::DownloadAssets(assetsplan);
         if (!assets)
         {
             qDebug() << "Failed to download assets.";
@@ -563,34 +626,8 @@ bool gui::StartVersion(const QString &username, const QString &loaderselected, c
         }
         qDebug() << "Assets downloaded.";
 
-        // - conversion.
-        mcapi::OS osenum;
-        if (osselected == "windows")
-            osenum = mcapi::OS::Windows;
-        else if (osselected == "linux")
-            osenum = mcapi::OS::Linux;
-        else if (osselected == "macos")
-            osenum = mcapi::OS::Macos;
-        else
-        {
-            qDebug() << "Invalid OS.";
-            return false;
-        }
-        mcapi::Arch archenum;
-        if (archselected == "x64")
-            archenum = mcapi::Arch::x64;
-        else if (archselected == "x32")
-            archenum = mcapi::Arch::x32;
-        else if (archselected == "arm64")
-            archenum = mcapi::Arch::arm64;
-        else
-        {
-            qDebug() << "Invalid architecture.";
-            return false;
-        }
-
         // - download java.
-        auto javaversionopt = mcapi::GetJavaVersion(mergedjson);
+        auto javaversionopt = mcapi::GetJavaVersion(profile);
         if (!javaversionopt)
         {
             qDebug() << "Failed to get java version.";
@@ -598,26 +635,41 @@ bool gui::StartVersion(const QString &username, const QString &loaderselected, c
         }
         int javaversion = *javaversionopt;
 
-        auto javaurlopt = mcapi::GetJavaDownloadUrl(javaversion, osenum, archenum);
-        if (!javaurlopt)
-        {
-            qDebug() << "Failed to get java download url.";
-            return false;
-        }
-        auto javaurl = *javaurlopt;
-
-        qDebug() << "Downloading java...";
-        auto javaopt = mcapi::DownloadJava(javaurl, versionid.toStdString());
+        // - versions needing the same major release share one runtime, only download when none is installed yet.
+        auto javaopt = mcapi::GetJavaRuntime(javaversion, osenum, archenum, versionid.toStdString());
         if (!javaopt)
         {
-            qDebug() << "Failed to download java.";
-            return false;
+            auto javapackageopt = mcapi::GetJavaPackage(javaversion, osenum, archenum);
+            if (javapackageopt)
+            {
+                qDebug() << "Downloading java" << QString::fromStdString(javapackageopt->release) << "...";
+                javaopt = mcapi::DownloadJava(*javapackageopt, javaversion, osenum, archenum, versionid.toStdString());
+            }
+            else
+            {
+                // - the assets api did not answer, fall back to the unpinned latest build.
+                auto javaurlopt = mcapi::GetJavaDownloadUrl(javaversion, osenum, archenum);
+                if (!javaurlopt)
+                {
+                    qDebug() << "Failed to get java download url.";
+                    return false;
+                }
+
+                qDebug() << "Downloading java...";
+                javaopt = mcapi::DownloadJava(*javaurlopt, javaversion, osenum, archenum, versionid.toStdString());
+            }
+
+            if (!javaopt)
+            {
+                qDebug() << "Failed to download java.";
+                return false;
+            }
+            qDebug() << "Java downloaded.";
         }
-        qDebug() << "Java downloaded.";
         auto java = *javaopt;
 
         // - download libraries.
-        auto librariesurlopt = mcapi::fabric::GetLoaderLibrariesDownloadUrl(mergedjson, osenum);
+        auto librariesurlopt = mcapi::fabric::GetLoaderLibrariesDownloadUrl(profile, osenum);
         if (!librariesurlopt)
         {
             qDebug() << "Failed to get libraries.";
@@ -635,7 +687,7 @@ bool gui::StartVersion(const QString &username, const QString &loaderselected, c
 
         // - extract natives.
         qDebug() << "Extracting natives...";
-        auto nativesurlopt = mcapi::vanilla::GetLibrariesNatives(versionid.toStdString(), mergedjson, osenum, archenum);
+        auto nativesurlopt = mcapi::vanilla::GetLibrariesNatives(versionid.toStdString(), profile, osenum, archenum);
         if (!nativesurlopt)
         {
             qDebug() << "Failed to get natives urls.";
@@ -661,7 +713,7 @@ bool gui::StartVersion(const QString &username, const QString &loaderselected, c
         // - build classpath.
         qDebug() << "Building classpath...";
         fs::path datapath = ".mcapi";
-        auto classpathopt = mcapi::vanilla::GetClassPath(mergedjson, *librariesdownloaded, (datapath / "versions" / versionid.toStdString() / "client.jar").string(), osenum);
+        auto classpathopt = mcapi::vanilla::GetClassPath(profile, *librariesdownloaded, (datapath / "versions" / versionid.toStdString() / "client.jar").string(), osenum);
         if (!classpathopt)
         {
             qDebug() << "Failed to build classpath.";
@@ -670,61 +722,85 @@ bool gui::StartVersion(const QString &username, const QString &loaderselected, c
         auto classpath = *classpathopt;
         qDebug() << "Classpath built.";
 
-        // - build launch command depending on whether the user is offline or logged in.
-        std::string launchcmd;
-        if (microsoft)
+        // - build the launch template once, then fill in whether the user is offline or logged in.
+        qDebug() << "Building launch command...";
+        auto launchtemplateopt = mcapi::vanilla::GetLaunchTemplate(classpath, profile, versionid.toStdString(), osenum);
+        if (!launchtemplateopt)
         {
-            qDebug() << "Building launch command...";
-            auto launchcmdopt = mcapi::vanilla::GetLaunchCommand(microsoftusername, classpath, mergedjson, versionid.toStdString(), osenum, microsoftuuid, microsoftaccesstoken, "msa");
-            if (!launchcmdopt)
-            {
-                qDebug() << "Failed to build launch command.";
-                return false;
-            }
-            launchcmd = *launchcmdopt;
-            qDebug() << "Launch command built.";
+            qDebug() << "Failed to build launch command.";
+            return false;
         }
+        auto launchtemplate = *launchtemplateopt;
+
+        std::string launchcmd;
+        if (microsoft)
+            launchcmd = mcapi::vanilla::GetLaunchCommandFromTemplate(launchtemplate, microsoftusername, microsoftuuid, microsoftaccesstoken, "msa");
         else
-        {
-            qDebug() << "Building launch command...";
-            auto launchcmdopt = mcapi::vanilla::GetLaunchCommand(username.toStdString(), classpath, mergedjson, versionid.toStdString(), osenum);
-            if (!launchcmdopt)
-            {
-                qDebug() << "Failed to build launch command.";
-                return false;
-            }
-            launchcmd = *launchcmdopt;
-            qDebug() << "Launch command built.";
-        }
+            launchcmd = mcapi::vanilla::GetLaunchCommandFromTemplate(launchtemplate, username.toStdString());
+        qDebug() << "Launch command built.";
 
         // - launch minecraft.
         std::string javapath;
         switch (osenum)
         {
         case mcapi::OS::Windows:
-            javapath = "runtime/" + versionid.toStdString() + "/java/bin/java.exe";
+            javapath = (fs::path(java) / "bin" / "java.exe").string();
             break;
 
         case mcapi::OS::Linux:
         case mcapi::OS::Macos:
-            javapath = "runtime/" + versionid.toStdString() + "/java/bin/java";
+            javapath = (fs::path(java) / "bin" / "java").string();
             break;
         }
-        bool launched = mcapi::StartProcess(javapath, launchcmd, osenum, &process, true);
-        if (!launched)
-        {
-            QMetaObject::invokeMethod(this, [this](){QMessageBox::critical(this, "error", "Failed to launch minecraft.");}, Qt::QueuedConnection);
-            return false;
-        }
-        else
-        {
-            QMetaObject::invokeMethod(this, [this](){QMessageBox::information(this, "info", "Minecraft launched.");}, Qt::QueuedConnection);
-            return true;
-        }
+
+        // - remember the resolved launch so the next start can skip the pipeline.
+        mcapi::Launchstamp stamp;
+        stamp.javapath = javapath;
+        stamp.nativesdir = (datapath / versionid.toStdString() / "natives").string();
+        stamp.classpath = classpath;
+        stamp.launchtemplate = launchtemplate;
+        stamp.jsonpath = (datapath / "versions" / versionid.toStdString() / (versionid.toStdString() + ".json")).string();
+        stamp.sourcesha1 = parententry.sha1;
+        stamp.clientjar = (datapath / "versions" / versionid.toStdString() / "client.jar").string();
+        stamp.os = osenum;
+        stamp.arch = archenum;
+        if (!mcapi::vanilla::SaveLaunchStamp(stampid, stamp))
+            qDebug() << "Failed to save launch stamp.";
+
+        // - runtimes no installed version points at anymore are dropped.
+        if (size_t removed = mcapi::CollectJavaRuntimes())
+            qDebug() << "Removed" << removed << "unused java runtimes.";
+
+        return LaunchVersion(javapath, launchcmd, osenum);
     }
     return false;
 }
 
+bool gui::LaunchStamp(const mcapi::Launchstamp &stamp, const QString &username, mcapi::OS osenum)
+{
+    std::string launchcmd;
+    if (microsoft)
+        launchcmd = mcapi::vanilla::GetLaunchCommandFromTemplate(stamp.launchtemplate, microsoftusername, microsoftuuid, microsoftaccesstoken, "msa");
+    else
+        launchcmd = mcapi::vanilla::GetLaunchCommandFromTemplate(stamp.launchtemplate, username.toStdString());
+    return LaunchVersion(stamp.javapath, launchcmd, osenum);
+}
+
+bool gui::LaunchVersion(const std::string &javapath, const std::string &launchcmd, mcapi::OS osenum)
+{
+    bool launched = mcapi::StartProcess(javapath, launchcmd, osenum, &process, true);
+    if (!launched)
+    {
+        QMetaObject::invokeMethod(this, [this](){QMessageBox::critical(this, "error", "Failed to launch minecraft.");}, Qt::QueuedConnection);
+        return false;
+    }
+    else
+    {
+        QMetaObject::invokeMethod(this, [this](){QMessageBox::information(this, "info", "Minecraft launched.");}, Qt::QueuedConnection);
+        return true;
+    }
+}
+
 void gui::on_startbutton_clicked()
 {
     if (processrunning.exchange(true))
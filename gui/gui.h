@@ -67,6 +67,8 @@ private:
 
     void GetVersions();
     bool StartVersion(const QString &username, const QString &loaderselected, const QString &versionselected, const QString &archselected, const QString &osselected);
+    bool LaunchStamp(const mcapi::Launchstamp &stamp, const QString &username, mcapi::OS osenum);
+    bool LaunchVersion(const std::string &javapath, const std::string &launchcmd, mcapi::OS osenum);
     bool StartMicrosoftLogin();
 };
 #endif // GUI_H